@@ -26,6 +26,48 @@ extern "C" {
 #define LIBCB_BUFFEROVERFLOW    -4
 #define LIBCB_BUFFERUNDERFLOW   -5
 #define LIBCB_MUTEXERROR        -6
+#define LIBCB_NOTSUPPORTED      -7
+#define LIBCB_SYSTEMERROR       -8
+#define LIBCB_TIMEOUT           -9
+#define LIBCB_WOULDBLOCK        -10
+#define LIBCB_NOTFOUND          -11
+#define LIBCB_CHECKSUMERROR     -12
+
+#define LIBCB_WAIT_FOREVER      0xFFFFFFFFu
+
+#define LIBCB_CACHELINE         64
+
+#define LIBCB_FLAG_NONE         0x00000000u
+#define LIBCB_FLAG_SPSC         0x00000001u // Lock-free single-producer/single-consumer mode
+#define LIBCB_FLAG_MIRRORED     0x00000002u // Library allocated storage mapped twice back-to-back
+#define LIBCB_FLAG_RECORD       0x00000004u // Buffer holds length-prefixed records
+#define LIBCB_FLAG_RECORDNOWRAP 0x00000008u // Records are padded so they never wrap
+#define LIBCB_FLAG_BLOCKING     0x00000010u // Track waiters for circularBufferPushWait/PopWait
+#define LIBCB_FLAG_OVERWRITE    0x00000020u // A push drops the oldest data instead of failing
+#define LIBCB_FLAG_POWEROFTWO   0x00000040u // Power of two size, masked free-running indexes
+
+#define LIBCB_FLAG_LOCKMASK     0x00000700u // Lock policy of the locked modes
+#define LIBCB_FLAG_LOCKCALLBACK 0x00000000u // pfnMutexLock/pfnMutexRelease, if set
+#define LIBCB_FLAG_LOCKNONE     0x00000100u // No locking, single thread or external lock
+#define LIBCB_FLAG_LOCKTICKET   0x00000200u // FIFO ticket spinlock
+#define LIBCB_FLAG_LOCKTTAS     0x00000300u // Test-and-test-and-set spinlock with backoff
+#define LIBCB_FLAG_LOCKADAPTIVE 0x00000400u // Spin briefly, then park on a futex (Linux only)
+
+#define LIBCB_FLAG_EVENTFD      0x00000800u // Readiness eventfds for epoll (Linux only)
+
+#define LIBCB_FLAG_COPYMASK     0x00007000u // Copy kernel of the data movement
+#define LIBCB_FLAG_COPYMEMCPY   0x00000000u // C library memcpy
+#define LIBCB_FLAG_COPYAUTO     0x00001000u // memcpy, non-temporal stores from LIBCB_COPY_STREAM_THRESHOLD on
+#define LIBCB_FLAG_COPYAVX2     0x00002000u // 32 byte AVX2 loads and stores (x86 only)
+#define LIBCB_FLAG_COPYAVX512   0x00003000u // 64 byte AVX-512 loads and stores (x86 only)
+#define LIBCB_FLAG_COPYSTREAM   0x00004000u // Non-temporal stores that bypass the cache (x86 only)
+
+#define LIBCB_FLAG_CRC          0x00008000u // Running CRC32C over the bytes of circularBufferPush
+#define LIBCB_FLAG_RECORDCRC    0x00010000u // Every record carries a CRC32C of its payload
+
+#ifndef LIBCB_COPY_STREAM_THRESHOLD
+#define LIBCB_COPY_STREAM_THRESHOLD (1u << 20) // Smallest copy LIBCB_FLAG_COPYAUTO streams
+#endif
 
 /// @brief this struct defines the initialization parameters
 typedef struct 
@@ -35,24 +77,145 @@ typedef struct
     int32_t(*pfnMutexInitialize)(uint32_t **pMutex); // Pointer to the mutex create function
     int32_t(*pfnMutexLock)(uint32_t *pMutex);   // Pointer to the mutex lock function
     int32_t(*pfnMutexRelease)(uint32_t *pMutex); // Pointer to the mutex unlock function
+    uint32_t nFlags;         // Operating mode of the buffer (LIBCB_FLAG_*), set by the initialization
 } CircularBufferInit;
 
+/// @brief this struct receives the counters of circularBufferGetStatistics
+/// @note  bytes are the bytes the indexes moved by, record headers and padding
+///        included, so nPushedBytes - nPoppedBytes minus the dropped bytes is the count
+typedef struct
+{
+    uint64_t nPushedBytes;   // Bytes added by successful producer calls
+    uint64_t nPushes;        // Successful producer calls
+    uint64_t nPoppedBytes;   // Bytes removed by successful consumer calls
+    uint64_t nPops;          // Successful consumer calls
+    uint64_t nOverflows;     // Producer calls rejected for lack of space
+    uint64_t nUnderflows;    // Consumer calls rejected for lack of data
+    uint64_t nLockAcquires;  // Acquisitions of the lock by the calls of the locked modes
+    uint64_t nLockWaitNs;    // Time spent acquiring the lock
+    uint64_t nLockWaitMaxNs; // Longest single acquisition of the lock
+    uint32_t nHighWater;     // Largest number of bytes stored after a push
+} CircularBufferStatistics;
+
+/// @brief this struct defines how circularBufferPush and circularBufferPushRecord
+///        grow the buffer and how the consumer side shrinks it again
+/// @note  pfnFree receives every storage the buffer moves away from, including
+///        the one passed to circularBufferInitialize
+typedef struct
+{
+    void *(*pfnAllocate)(uint32_t nSize, void *pContext);           // Returns nSize bytes of storage, NULL on failure
+    void (*pfnFree)(void *pBuffer, uint32_t nSize, void *pContext); // Releases storage the buffer moved away from
+    void *pContext;        // Passed to pfnAllocate and pfnFree
+    uint32_t nMaxSize;     // Ceiling of the growth
+    uint32_t nMinSize;     // Floor of the shrinking, 0 never shrinks
+    uint32_t nShrinkAfter; // Pops between two checks for underuse
+} CircularBufferResizePolicy;
+
 /// @brief this structure defines the circular buffer
+/// @note  in LIBCB_FLAG_SPSC mode nHead is only written by the consumer and
+///        nTail only by the producer, both run in the range [0, 2 * nBufferSize)
+///        and nCount is not maintained, use circularBufferGetCount instead
+/// @note  in LIBCB_FLAG_POWEROFTWO mode nHead and nTail run freely over the whole
+///        uint32_t range, the count is nTail - nHead and nCount is not maintained
+/// @note  producer and consumer state sit on separate cache lines, in
+///        LIBCB_FLAG_SPSC mode each side only reads the index of the other side
+///        when its cached copy makes the buffer look full or empty
 typedef struct
 {
     CircularBufferInit init; // Initialization parameters
     uint32_t *pMutex;
     uint32_t nCount;   // Number of bytes in the buffer
-    uint32_t nHead;    // Index of the first byte in the buffer
-    uint32_t nTail;    // Index of the last byte in the buffer
+    uint32_t nLockWord;    // State of the TTAS and adaptive lock policies
+    uint32_t nLockTicket;  // Next ticket of the ticket lock policy
+    uint32_t nLockServing; // Ticket holding the ticket lock policy
+    int32_t nReadableFd;   // eventfd signalled when data arrives for an armed consumer
+    int32_t nWritableFd;   // eventfd signalled when space is freed for an armed producer
+    void (*pfnCopy)(void *pDestination, const void *pSource, uint32_t nSize); // Kernel of the LIBCB_FLAG_COPY* bits
+    void (*pfnCopyOut)(void *pDestination, const void *pSource, uint32_t nSize); // Same kernel without non-temporal stores, for pops
+    const CircularBufferResizePolicy *pResizePolicy; // Growth and shrinking, NULL keeps the size fixed
+    uint32_t nResizePeak; // Largest count seen by the consumer since the last check for underuse
+    uint32_t nResizePops; // Pops since the last check for underuse
+#ifdef LIBCB_ENABLE_STATISTICS
+    uint64_t nStatLockAcquires;  // Statistics of the lock, written by both sides
+    uint64_t nStatLockWaitNs;
+    uint64_t nStatLockWaitMaxNs;
+#endif
+    uint8_t aPad0[LIBCB_CACHELINE];
+    uint32_t nTail;       // Index of the last byte in the buffer
+    uint32_t nCachedHead; // Last nHead seen by the producer
+    uint32_t nReserved;   // Bytes handed out by circularBufferReserve
+    uint64_t nDroppedBytes;   // Bytes discarded by LIBCB_FLAG_OVERWRITE
+    uint64_t nDroppedRecords; // Records discarded by LIBCB_FLAG_OVERWRITE
+    uint32_t nPushedCrc;      // CRC32C of the bytes pushed in LIBCB_FLAG_CRC mode
+#ifdef LIBCB_ENABLE_STATISTICS
+    uint64_t nStatPushedBytes; // Statistics of the producer side
+    uint64_t nStatPushes;
+    uint64_t nStatOverflows;
+    uint32_t nStatHighWater;
+#endif
+    uint8_t aPad1[LIBCB_CACHELINE];
+    uint32_t nHead;       // Index of the first byte in the buffer
+    uint32_t nCachedTail; // Last nTail seen by the consumer
+    uint32_t nPeeked;     // Bytes handed out by circularBufferPeek
+#ifdef LIBCB_ENABLE_STATISTICS
+    uint64_t nStatPoppedBytes; // Statistics of the consumer side
+    uint64_t nStatPops;
+    uint64_t nStatUnderflows;
+#endif
+    uint8_t aPad2[LIBCB_CACHELINE];
+    uint32_t nPushSequence; // Futex word moved when space is freed for a waiting producer
+    uint32_t nPopSequence;  // Futex word moved when data is added for a waiting consumer
+    uint32_t nPushWaiters;  // Producers parked in circularBufferPushWait
+    uint32_t nPopWaiters;   // Consumers parked in circularBufferPopWait
+    uint32_t nReadArmed;    // A consumer found the buffer empty since the last signal
+    uint32_t nWriteArmed;   // A producer found the buffer full since the last signal
+    uint8_t aPad3[LIBCB_CACHELINE];
 } CircularBuffer;
 
-/// @brief this function initializes the circular buffer
+/// @brief this function initializes the circular buffer in LIBCB_FLAG_NONE mode
 /// @param self pointer to the circular buffer
-/// @param init initialize parameter of the circular buffer
+/// @param init initialize parameter of the circular buffer, nFlags is not read
 /// @return 
 int32_t circularBufferInitialize(CircularBuffer *self, CircularBufferInit init);
 
+/// @brief this function initializes the circular buffer in the given mode
+/// @param self pointer to the circular buffer
+/// @param init initialize parameter of the circular buffer, nFlags is not read
+/// @param nFlags operating mode of the buffer (LIBCB_FLAG_*)
+/// @note  with LIBCB_FLAG_SPSC the mutex callbacks are never called, exactly
+///        one thread may push and exactly one thread may pop concurrently
+/// @note  with LIBCB_FLAG_MIRRORED pBuffer must be NULL, the storage is allocated
+///        by the library, nBufferSize is rounded up to the page size and every
+///        region of the buffer is contiguous (Linux only)
+/// @note  with LIBCB_FLAG_OVERWRITE circularBufferPush, circularBufferPushRecord,
+///        circularBufferPushPartial and circularBufferReserve advance nHead to make
+///        room, whole records are dropped in LIBCB_FLAG_RECORD mode, data that
+///        cannot fit into the empty buffer fails without dropping anything, it
+///        cannot be combined with LIBCB_FLAG_SPSC
+/// @note  the LIBCB_FLAG_LOCK* bits select the lock of the locked modes, the
+///        callbacks are only used with LIBCB_FLAG_LOCKCALLBACK, a failing callback
+///        makes the operation return LIBCB_MUTEXERROR
+/// @note  with LIBCB_FLAG_EVENTFD two non-blocking eventfds are created, see
+///        circularBufferGetReadableFd and circularBufferGetWritableFd
+/// @note  the LIBCB_FLAG_COPY* bits select the kernel every push and pop copies
+///        with, the choice is made once here from CPUID and a kernel the CPU
+///        does not support makes the call return LIBCB_NOTSUPPORTED, pops never
+///        use non-temporal stores because the caller reads the data next
+/// @note  with LIBCB_FLAG_CRC circularBufferPush copies and checksums in one
+///        pass, see circularBufferGetPushedCrc, LIBCB_FLAG_RECORDCRC requires
+///        LIBCB_FLAG_RECORD and stores a CRC32C behind every record payload,
+///        a record buffer must be larger than the header and the CRC together
+/// @note  with LIBCB_FLAG_POWEROFTWO a supplied buffer is used up to the largest
+///        power of two that fits, a mirrored buffer is rounded up instead, the
+///        resulting size is left in init.nBufferSize
+/// @return 
+int32_t circularBufferInitializeWithFlags(CircularBuffer *self, CircularBufferInit init, uint32_t nFlags);
+
+/// @brief this function releases the resources allocated by circularBufferInitialize
+/// @param self pointer to the circular buffer
+/// @return 
+int32_t circularBufferDeinitialize(CircularBuffer *self);
+
 /// @brief this function removes all data from the circular buffer
 /// @param self pointer to the circular buffer
 /// @return 
@@ -72,6 +235,23 @@ int32_t circularBufferPush(CircularBuffer *self, void *pSource, uint32_t nSource
 /// @return 
 int32_t circularBufferPop(CircularBuffer *self, void *pDestination, uint32_t nDestinationSize);
 
+/// @brief this function returns how much data LIBCB_FLAG_OVERWRITE has
+///        discarded since initialization
+/// @param self
+/// @param pnBytes receives the number of dropped bytes, may be NULL
+/// @param pnRecords receives the number of dropped records, may be NULL
+/// @return
+int32_t circularBufferGetDropped(CircularBuffer *self, uint64_t *pnBytes, uint64_t *pnRecords);
+
+/// @brief this function takes a snapshot of the statistics of the buffer
+/// @param self pointer to the circular buffer
+/// @param pStatistics receives the counters
+/// @param bReset TRUE to clear every counter as it is read
+/// @note  the counters are relaxed atomics on the side that owns them, a snapshot
+///        taken while other threads run is not a consistent cut across counters
+/// @return LIBCB_NOTSUPPORTED unless the library is built with LIBCB_ENABLE_STATISTICS
+int32_t circularBufferGetStatistics(CircularBuffer *self, CircularBufferStatistics *pStatistics, uint8_t bReset);
+
 /// @brief this function checks if the circular buffer is empty
 /// @param self
 /// @return 
@@ -0,0 +1,246 @@
+#ifndef INCLUDED_LIBCIRCULARBUFFER_HPP
+#define INCLUDED_LIBCIRCULARBUFFER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace libcb
+{
+
+/// @brief this lock policy does nothing, the ring has to be used by a single
+///        thread or be synchronized by the caller
+struct NullLock
+{
+    void lock() {}
+    void unlock() {}
+};
+
+/// @brief this lock policy serializes every operation with a std::mutex
+struct MutexLock
+{
+    void lock() { mutex.lock(); }
+    void unlock() { mutex.unlock(); }
+
+    std::mutex mutex;
+};
+
+namespace detail
+{
+
+/// @brief index arithmetic of a ring with a power of two capacity, the
+///        indexes run freely over the whole uint32_t range
+template <uint32_t N, bool PowerOfTwo = (N & (N - 1)) == 0>
+struct RingIndex
+{
+    static constexpr uint32_t toOffset(uint32_t nIndex) { return nIndex & (N - 1); }
+    static constexpr uint32_t advance(uint32_t nIndex, uint32_t nSize) { return nIndex + nSize; }
+    static constexpr uint32_t distance(uint32_t nHead, uint32_t nTail) { return nTail - nHead; }
+};
+
+/// @brief index arithmetic of any other capacity, the indexes run in the
+///        range [0, 2 * N) to tell full from empty like the C lock-free mode
+template <uint32_t N>
+struct RingIndex<N, false>
+{
+    static constexpr uint32_t toOffset(uint32_t nIndex) { return nIndex < N ? nIndex : nIndex - N; }
+    static constexpr uint32_t advance(uint32_t nIndex, uint32_t nSize) { return nIndex + nSize < 2 * N ? nIndex + nSize : nIndex + nSize - 2 * N; }
+    static constexpr uint32_t distance(uint32_t nHead, uint32_t nTail) { return nTail >= nHead ? nTail - nHead : nTail + 2 * N - nHead; }
+};
+
+} // namespace detail
+
+/// @brief this class template is a typed circular buffer with a compile time
+///        capacity of N elements, the storage lives inside the object
+/// @note  the index math folds to a mask when N is a power of two, trivially
+///        copyable elements are moved in bulk with at most two memcpy calls
+/// @note  LockPolicy is NullLock or MutexLock, or any type with lock/unlock
+template <typename T, uint32_t N, typename LockPolicy = NullLock>
+class Ring
+{
+    static_assert(N > 0 && N <= 0x80000000u, "capacity must be in [1, 2^31]");
+
+    typedef detail::RingIndex<N> Index;
+
+public:
+    Ring() : nHead(0), nTail(0) {}
+
+    ~Ring() { clear(); }
+
+    Ring(const Ring &) = delete;
+    Ring &operator=(const Ring &) = delete;
+
+    /// @brief this function returns the number of elements the ring can hold
+    static constexpr uint32_t capacity() { return N; }
+
+    /// @brief this function returns the number of elements currently stored
+    uint32_t size()
+    {
+        std::lock_guard<LockPolicy> guard(lockPolicy);
+
+        return Index::distance(nHead, nTail);
+    }
+
+    bool empty() { return size() == 0; }
+
+    bool full() { return size() == N; }
+
+    /// @brief this function constructs one element in place at the tail
+    /// @return false if the ring is full, nothing is constructed then
+    template <typename... Args>
+    bool emplace(Args &&... args)
+    {
+        std::lock_guard<LockPolicy> guard(lockPolicy);
+
+        if (Index::distance(nHead, nTail) == N)
+        {
+            return false;
+        }
+
+        // the tail only moves once the constructor did not throw
+        new (slot(nTail)) T(std::forward<Args>(args)...);
+        nTail = Index::advance(nTail, 1);
+
+        return true;
+    }
+
+    bool push(const T &value) { return emplace(value); }
+
+    bool push(T &&value) { return emplace(std::move(value)); }
+
+    /// @brief this function moves the oldest element into value and destroys it
+    /// @return false if the ring is empty
+    bool pop(T &value)
+    {
+        std::lock_guard<LockPolicy> guard(lockPolicy);
+
+        if (nHead == nTail)
+        {
+            return false;
+        }
+
+        T *pElement = slot(nHead);
+
+        value = std::move(*pElement);
+        pElement->~T();
+        nHead = Index::advance(nHead, 1);
+
+        return true;
+    }
+
+    /// @brief this function copies as many of the nCount elements as fit
+    /// @note  if a copy constructor throws, the elements copied before it stay
+    ///        in the ring and the exception propagates
+    /// @return number of elements pushed, 0 if the ring is full
+    uint32_t push(const T *pValues, uint32_t nCount)
+    {
+        std::lock_guard<LockPolicy> guard(lockPolicy);
+
+        uint32_t nFree = N - Index::distance(nHead, nTail);
+
+        nCount = nCount < nFree ? nCount : nFree;
+
+        copyIn(pValues, nCount, std::is_trivially_copyable<T>());
+
+        return nCount;
+    }
+
+    /// @brief this function moves up to nCount of the oldest elements out
+    /// @note  if a move assignment throws, the elements moved before it are
+    ///        gone from the ring and the exception propagates
+    /// @return number of elements popped, 0 if the ring is empty
+    uint32_t pop(T *pValues, uint32_t nCount)
+    {
+        std::lock_guard<LockPolicy> guard(lockPolicy);
+
+        uint32_t nUsed = Index::distance(nHead, nTail);
+
+        nCount = nCount < nUsed ? nCount : nUsed;
+
+        copyOut(pValues, nCount, std::is_trivially_copyable<T>());
+
+        return nCount;
+    }
+
+    /// @brief this function destroys all stored elements
+    void clear()
+    {
+        std::lock_guard<LockPolicy> guard(lockPolicy);
+
+        while (nHead != nTail)
+        {
+            slot(nHead)->~T();
+            nHead = Index::advance(nHead, 1);
+        }
+    }
+
+private:
+    T *slot(uint32_t nIndex)
+    {
+        return reinterpret_cast<T *>(&aStorage[Index::toOffset(nIndex)]);
+    }
+
+    // split the run starting at the index into the part before and after the wrap
+    static uint32_t firstRun(uint32_t nIndex, uint32_t nCount)
+    {
+        uint32_t nOffset = Index::toOffset(nIndex);
+
+        return nCount < N - nOffset ? nCount : N - nOffset;
+    }
+
+    void copyIn(const T *pValues, uint32_t nCount, std::true_type)
+    {
+        uint32_t nFirst = firstRun(nTail, nCount);
+
+        std::memcpy(slot(nTail), pValues, nFirst * sizeof(T));
+        std::memcpy(&aStorage[0], pValues + nFirst, (nCount - nFirst) * sizeof(T));
+        nTail = Index::advance(nTail, nCount);
+    }
+
+    void copyIn(const T *pValues, uint32_t nCount, std::false_type)
+    {
+        // the tail covers every element as soon as it is built, so the ring
+        // destroys what was built when a later copy constructor throws
+        for (uint32_t i = 0; i < nCount; i++)
+        {
+            new (slot(nTail)) T(pValues[i]);
+            nTail = Index::advance(nTail, 1);
+        }
+    }
+
+    void copyOut(T *pValues, uint32_t nCount, std::true_type)
+    {
+        uint32_t nFirst = firstRun(nHead, nCount);
+
+        std::memcpy(pValues, slot(nHead), nFirst * sizeof(T));
+        std::memcpy(pValues + nFirst, &aStorage[0], (nCount - nFirst) * sizeof(T));
+        nHead = Index::advance(nHead, nCount);
+    }
+
+    void copyOut(T *pValues, uint32_t nCount, std::false_type)
+    {
+        // the head passes every element as soon as it is destroyed, so the
+        // ring never destroys it again when a later move assignment throws
+        for (uint32_t i = 0; i < nCount; i++)
+        {
+            T *pElement = slot(nHead);
+
+            pValues[i] = std::move(*pElement);
+            pElement->~T();
+            nHead = Index::advance(nHead, 1);
+        }
+    }
+
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type aStorage[N];
+    uint32_t nHead; // Index of the oldest element
+    uint32_t nTail; // Index of the next free slot
+    LockPolicy lockPolicy;
+};
+
+} // namespace libcb
+
+#endif // INCLUDED_LIBCIRCULARBUFFER_HPP
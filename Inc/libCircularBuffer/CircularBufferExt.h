@@ -7,6 +7,19 @@
 extern "C" {
 #endif
 
+#define LIBCB_RECORD_HEADER_SIZE    4   // Bytes stored in front of every record
+#define LIBCB_RECORD_CRC_SIZE       4   // Bytes stored behind every record with LIBCB_FLAG_RECORDCRC
+
+#define LIBCB_BATCH_ALLORNOTHING    0   // Move every buffer of a batch or none of them
+#define LIBCB_BATCH_PARTIAL         1   // Move the leading buffers of a batch that fit
+
+/// @brief this struct defines a contiguous region of the circular buffer
+typedef struct
+{
+    void *pData;    // Pointer to the first byte of the region
+    uint32_t nSize; // Number of bytes in the region
+} CircularBufferSpan;
+
 /// @brief this function reads data with the count of nCount 
 ///        from the circular buffer starting from the specified 
 ///        offset nStartOffset
@@ -25,6 +38,268 @@ int32_t circularBufferRead(
     uint32_t nCount
 );
 
+/// @brief this function continues a CRC32C (Castagnoli) over the data, with
+///        the SSE4.2 crc32 instruction when the CPU has it
+/// @param nCrc CRC of the preceding data, 0 to start
+/// @param pData pointer to the data
+/// @param nSize number of bytes
+/// @return CRC including the data
+uint32_t circularBufferCrc32c(uint32_t nCrc, const void *pData, uint32_t nSize);
+
+/// @brief this function returns the CRC32C of the bytes stored in the range
+///        without copying them out
+/// @param self pointer to the circular buffer
+/// @param nStartOffset offset of the range from the oldest byte
+/// @param nCount number of bytes in the range
+/// @param pnCrc receives the CRC
+/// @return LIBCB_BUFFERUNDERFLOW if the range exceeds the stored data
+int32_t circularBufferCrc(CircularBuffer *self, uint32_t nStartOffset, uint32_t nCount, uint32_t *pnCrc);
+
+/// @brief this function returns the running CRC32C of every byte added to the
+///        stream since initialization or the last reset, the checksum is computed
+///        while circularBufferPush and circularBufferPushPartial copy the data in,
+///        bytes published by circularBufferCommit and circularBufferPushv are
+///        read back once, records of LIBCB_FLAG_RECORD are not part of the stream
+/// @param self pointer to the circular buffer, initialized with LIBCB_FLAG_CRC
+/// @param pnCrc receives the CRC
+/// @param bReset TRUE to start the next CRC over, call it from the producer then
+/// @return LIBCB_INVALIDPARAM without LIBCB_FLAG_CRC
+int32_t circularBufferGetPushedCrc(CircularBuffer *self, uint32_t *pnCrc, uint8_t bReset);
+
+/// @brief this function searches the stored data for a byte in place, the
+///        scan runs with memchr over the one or two used regions
+/// @param self pointer to the circular buffer
+/// @param nByte byte to search for, e.g. a line or frame delimiter
+/// @param nStartOffset offset from the oldest byte the search starts at
+/// @return offset of the first match relative to the oldest byte,
+///         LIBCB_NOTFOUND if there is none, LIBCB_BUFFEREMPTY if there is no data,
+///         LIBCB_BUFFERUNDERFLOW if nStartOffset is beyond the stored data
+int32_t circularBufferFind(CircularBuffer *self, uint8_t nByte, uint32_t nStartOffset);
+
+/// @brief this function searches the stored data for a short byte pattern in
+///        place, a match may be split at the end of the buffer
+/// @param self pointer to the circular buffer
+/// @param pPattern pointer to the pattern
+/// @param nPatternSize size of the pattern
+/// @param nStartOffset offset from the oldest byte the search starts at
+/// @note  candidates are located with memchr on the first byte of the pattern,
+///        patterns with a rare first byte are found fastest
+/// @return offset of the first match relative to the oldest byte,
+///         LIBCB_NOTFOUND if there is none, LIBCB_BUFFEREMPTY if there is no data,
+///         LIBCB_BUFFERUNDERFLOW if nStartOffset is beyond the stored data
+int32_t circularBufferFindPattern(CircularBuffer *self, const void *pPattern, uint32_t nPatternSize, uint32_t nStartOffset);
+
+/// @brief this function reserves nSize bytes of free space for the caller to
+///        write into directly, the region is returned as up to two spans because
+///        it may wrap around the end of the buffer (aSpans[1].nSize is 0 otherwise)
+/// @param self pointer to the circular buffer
+/// @param nSize number of bytes to reserve
+/// @param aSpans receives the writable regions in order
+/// @note  unless LIBCB_FLAG_SPSC is set the mutex is held from a successful
+///        reserve until the matching circularBufferCommit
+/// @note  a resize policy grows the storage like circularBufferPush does, the
+///        call fails with LIBCB_INVALIDPARAM in LIBCB_FLAG_RECORD mode
+/// @return LIBCB_BUFFEROVERFLOW if there is not enough free space
+int32_t circularBufferReserve(CircularBuffer *self, uint32_t nSize, CircularBufferSpan aSpans[2]);
+
+/// @brief this function publishes the first nSize bytes written into the
+///        reserved region and ends the reservation
+/// @param self pointer to the circular buffer
+/// @param nSize number of bytes to publish, may be less than reserved or 0
+/// @note  a commit of 0 bytes releases the reservation without waking or
+///        signalling a consumer
+/// @return
+int32_t circularBufferCommit(CircularBuffer *self, uint32_t nSize);
+
+/// @brief this function returns the readable data in place without copying,
+///        the region is returned as up to two spans because it may wrap around
+///        the end of the buffer (aSpans[1].nSize is 0 otherwise)
+/// @param self pointer to the circular buffer
+/// @param aSpans receives the readable regions in order
+/// @note  unless LIBCB_FLAG_SPSC is set the mutex is held from a successful
+///        peek until the matching circularBufferConsume
+/// @note  the call fails with LIBCB_INVALIDPARAM in LIBCB_FLAG_RECORD mode, use
+///        circularBufferPopRecord there
+/// @return LIBCB_BUFFEREMPTY if there is nothing to read
+int32_t circularBufferPeek(CircularBuffer *self, CircularBufferSpan aSpans[2]);
+
+/// @brief this function drops the first nSize bytes of the peeked data
+///        without copying and ends the peek
+/// @param self pointer to the circular buffer
+/// @param nSize number of bytes to skip, may be less than peeked or 0
+/// @return
+int32_t circularBufferConsume(CircularBuffer *self, uint32_t nSize);
+
+/// @brief this function stores the source as one record, the length header
+///        and the payload are published together in a single operation
+/// @param self pointer to the circular buffer, initialized with LIBCB_FLAG_RECORD
+/// @param pSource pointer to the payload
+/// @param nSourceSize size of the payload
+/// @note  with LIBCB_FLAG_RECORDNOWRAP a record that would wrap is moved to the
+///        start of the buffer and the skipped bytes count as used until popped
+/// @return LIBCB_BUFFEROVERFLOW if the record does not fit
+int32_t circularBufferPushRecord(CircularBuffer *self, const void *pSource, uint32_t nSourceSize);
+
+/// @brief this function removes the oldest record and copies its payload
+/// @param self pointer to the circular buffer, initialized with LIBCB_FLAG_RECORD
+/// @param pDestination pointer to the destination buffer
+/// @param nDestinationSize size of the destination buffer
+/// @param pnSize receives the size of the payload, may be NULL
+/// @note  with LIBCB_FLAG_RECORDCRC the payload is checked while it is copied
+/// @return LIBCB_BUFFEROVERFLOW if the payload does not fit into the
+///         destination, the record is left in the buffer in that case,
+///         LIBCB_CHECKSUMERROR if the payload does not match its CRC32C, the
+///         record is removed and copied nevertheless
+int32_t circularBufferPopRecord(CircularBuffer *self, void *pDestination, uint32_t nDestinationSize, uint32_t *pnSize);
+
+/// @brief this function returns the payload size of the oldest record
+///        without removing it
+/// @param self pointer to the circular buffer, initialized with LIBCB_FLAG_RECORD
+/// @return LIBCB_BUFFEREMPTY if there is no record
+int32_t circularBufferGetNextRecordSize(CircularBuffer *self);
+
+/// @brief this function pushes a batch of buffers with a single lock
+///        acquisition, capacity check and tail update
+/// @param self pointer to the circular buffer
+/// @param aSources buffers to push in order, each one is a record in LIBCB_FLAG_RECORD mode
+/// @param nSourceCount number of buffers
+/// @param nMode LIBCB_BATCH_ALLORNOTHING or LIBCB_BATCH_PARTIAL
+/// @return number of buffers pushed, LIBCB_BUFFEROVERFLOW if an all-or-nothing
+///         batch does not fit
+int32_t circularBufferPushv(CircularBuffer *self, const CircularBufferSpan *aSources, uint32_t nSourceCount, uint32_t nMode);
+
+/// @brief this function pops into a batch of buffers with a single lock
+///        acquisition, availability check and head update
+/// @param self pointer to the circular buffer
+/// @param aDestinations buffers to fill in order, every buffer is filled completely,
+///        in LIBCB_FLAG_RECORD mode each receives one record and nSize is set
+///        to the size of that record
+/// @param nDestinationCount number of buffers
+/// @param nMode LIBCB_BATCH_ALLORNOTHING or LIBCB_BATCH_PARTIAL
+/// @return number of buffers filled, LIBCB_BUFFERUNDERFLOW if an all-or-nothing
+///         batch cannot be filled, LIBCB_NOTSUPPORTED with LIBCB_FLAG_RECORDCRC
+int32_t circularBufferPopv(CircularBuffer *self, CircularBufferSpan *aDestinations, uint32_t nDestinationCount, uint32_t nMode);
+
+/// @brief this function copies as many bytes of the source as fit into the
+///        circular buffer, like write(2)
+/// @param self pointer to the circular buffer
+/// @param pSource pointer to the source buffer
+/// @param nSourceSize maximum number of bytes to push
+/// @return number of bytes pushed, 0 if the buffer is full
+int32_t circularBufferPushPartial(CircularBuffer *self, const void *pSource, uint32_t nSourceSize);
+
+/// @brief this function copies as many bytes as are available, up to
+///        nDestinationSize, from the circular buffer, like read(2)
+/// @param self pointer to the circular buffer
+/// @param pDestination pointer to the destination buffer
+/// @param nDestinationSize maximum number of bytes to pop
+/// @return number of bytes popped, 0 if the buffer is empty
+int32_t circularBufferPopPartial(CircularBuffer *self, void *pDestination, uint32_t nDestinationSize);
+
+/// @brief this function pushes like circularBufferPush but waits for free
+///        space instead of failing with LIBCB_BUFFEROVERFLOW
+/// @param self pointer to the circular buffer, initialized with LIBCB_FLAG_BLOCKING
+/// @param pSource pointer to the source buffer
+/// @param nSourceSize number of bytes to push
+/// @param nTimeoutMs maximum time to wait or LIBCB_WAIT_FOREVER
+/// @note  the caller only parks on a futex when the buffer is full, pushes and
+///        pops only issue a wakeup while somebody is actually parked (Linux only)
+/// @return LIBCB_TIMEOUT if the space did not become available in time
+int32_t circularBufferPushWait(CircularBuffer *self, void *pSource, uint32_t nSourceSize, uint32_t nTimeoutMs);
+
+/// @brief this function pops like circularBufferPop but waits for enough
+///        data instead of failing with LIBCB_BUFFEREMPTY or LIBCB_BUFFERUNDERFLOW
+/// @param self pointer to the circular buffer, initialized with LIBCB_FLAG_BLOCKING
+/// @param pDestination pointer to the destination buffer
+/// @param nDestinationSize number of bytes to pop
+/// @param nTimeoutMs maximum time to wait or LIBCB_WAIT_FOREVER
+/// @return LIBCB_TIMEOUT if the data did not arrive in time
+int32_t circularBufferPopWait(CircularBuffer *self, void *pDestination, uint32_t nDestinationSize, uint32_t nTimeoutMs);
+
+/// @brief this function pushes like circularBufferPush but copies with the
+///        kernel given for this call instead of the one chosen at initialization
+/// @param self pointer to the circular buffer
+/// @param pSource pointer to the source buffer
+/// @param nSourceSize number of bytes to push
+/// @param nCopy one of the LIBCB_FLAG_COPY* values
+/// @return LIBCB_NOTSUPPORTED if the CPU lacks the instructions of the kernel
+int32_t circularBufferPushCopy(CircularBuffer *self, void *pSource, uint32_t nSourceSize, uint32_t nCopy);
+
+/// @brief this function pops like circularBufferPop but copies with the
+///        kernel given for this call instead of the one chosen at initialization
+/// @param self pointer to the circular buffer
+/// @param pDestination pointer to the destination buffer
+/// @param nDestinationSize number of bytes to pop
+/// @param nCopy one of the LIBCB_FLAG_COPY* values
+/// @return LIBCB_NOTSUPPORTED if the CPU lacks the instructions of the kernel
+int32_t circularBufferPopCopy(CircularBuffer *self, void *pDestination, uint32_t nDestinationSize, uint32_t nCopy);
+
+/// @brief this function reads from the file descriptor straight into the free
+///        space of the buffer with a single readv over its one or two free regions
+/// @param self pointer to the circular buffer, not in LIBCB_FLAG_RECORD mode
+/// @param nFd file descriptor to read from, may be non-blocking
+/// @param nMaxSize maximum number of bytes to read, 0 for all free space
+/// @note  unless LIBCB_FLAG_SPSC is set the lock is held during the system call,
+///        a blocking descriptor blocks every other user of the buffer meanwhile
+/// @return number of bytes read, 0 at the end of the file, LIBCB_BUFFERFULL if
+///         there is no free space, LIBCB_WOULDBLOCK if a non-blocking descriptor
+///         has no data, LIBCB_SYSTEMERROR with errno set on any other failure
+int32_t circularBufferReadFromFd(CircularBuffer *self, int nFd, uint32_t nMaxSize);
+
+/// @brief this function writes the oldest data of the buffer straight to the
+///        file descriptor with a single writev over its one or two used regions,
+///        only the bytes the descriptor accepted are removed
+/// @param self pointer to the circular buffer, not in LIBCB_FLAG_RECORD mode
+/// @param nFd file descriptor to write to, may be non-blocking
+/// @param nMaxSize maximum number of bytes to write, 0 for all data
+/// @note  unless LIBCB_FLAG_SPSC is set the lock is held during the system call
+/// @return number of bytes written, LIBCB_BUFFEREMPTY if there is no data,
+///         LIBCB_WOULDBLOCK if a non-blocking descriptor is full,
+///         LIBCB_SYSTEMERROR with errno set on any other failure
+int32_t circularBufferWriteToFd(CircularBuffer *self, int nFd, uint32_t nMaxSize);
+
+/// @brief this function returns the eventfd that becomes readable when data
+///        arrives after a consumer found the buffer empty
+/// @param self pointer to the circular buffer, initialized with LIBCB_FLAG_EVENTFD
+/// @note  the descriptor is only signalled on that edge, an event loop reads
+///        the eventfd to reset it and pops until the buffer reports empty, which
+///        arms the next signal, steady state pushes never enter the kernel
+/// @return the file descriptor or LIBCB_INVALIDPARAM
+int32_t circularBufferGetReadableFd(CircularBuffer *self);
+
+/// @brief this function returns the eventfd that becomes readable when space
+///        is freed after a producer found the buffer full, it starts signalled
+///        because a new buffer is writable
+/// @param self pointer to the circular buffer, initialized with LIBCB_FLAG_EVENTFD
+/// @note  a push, reserve or record push that fails for lack of space arms it
+/// @return the file descriptor or LIBCB_INVALIDPARAM
+int32_t circularBufferGetWritableFd(CircularBuffer *self);
+
+/// @brief this function moves the stored data to new storage of another size,
+///        unwrapped so the oldest byte lands at offset 0
+/// @param self pointer to the circular buffer
+/// @param pBuffer new storage of nBufferSize bytes
+/// @param nBufferSize size of the new storage, a power of two in LIBCB_FLAG_POWEROFTWO mode
+/// @param ppOldBuffer receives the storage the buffer moved away from, may be NULL
+/// @note  in LIBCB_FLAG_RECORDNOWRAP mode the padding between records is dropped
+/// @return LIBCB_BUFFEROVERFLOW if the stored data does not fit the new storage,
+///         LIBCB_NOTSUPPORTED with LIBCB_FLAG_SPSC or LIBCB_FLAG_MIRRORED
+int32_t circularBufferResize(CircularBuffer *self, void *pBuffer, uint32_t nBufferSize, void **ppOldBuffer);
+
+/// @brief this function lets the buffer resize itself, a push that finds too
+///        little space moves to storage at least twice the size up to nMaxSize,
+///        and every nShrinkAfter pops the consumer halves the storage down to
+///        nMinSize when the count never exceeded a quarter of it
+/// @param self pointer to the circular buffer
+/// @param pPolicy policy, kept by reference, NULL keeps the current size from now on
+/// @note  circularBufferPush, circularBufferPushRecord and circularBufferReserve
+///        grow, every call that removes data counts towards a shrink, the rest
+///        work on the current size
+/// @note  the storage moves under the lock, a span from circularBufferReserve or
+///        circularBufferPeek is only valid until the matching commit or consume
+/// @return LIBCB_NOTSUPPORTED with LIBCB_FLAG_SPSC or LIBCB_FLAG_MIRRORED
+int32_t circularBufferSetResizePolicy(CircularBuffer *self, const CircularBufferResizePolicy *pPolicy);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,118 @@
+#ifndef INCLUDED_LIBCIRCULARBUFFERFILE_H
+#define INCLUDED_LIBCIRCULARBUFFERFILE_H
+
+#include "CircularBuffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LIBCB_FILE_MAGIC        0x46424342u // "BCBF"
+#define LIBCB_FILE_VERSION      1u
+
+#define LIBCB_FILE_FLAG_NONE    0x00000000u // Byte ring
+#define LIBCB_FILE_FLAG_RECORD  0x00000001u // Records with a length and a CRC32C header
+
+#define LIBCB_FILE_SYNC_NONE    0u // Leave write back to the kernel, survives a process crash
+#define LIBCB_FILE_SYNC_ASYNC   1u // Schedule write back after every operation
+#define LIBCB_FILE_SYNC_ALWAYS  2u // Write data, then header, synchronously on every operation
+
+#define LIBCB_FILE_RECORD_HEADER_SIZE 8 // Length and CRC32C in front of every record
+
+/// @brief this struct is the header page at the start of the file, it is the
+///        only state recovery reads, the data is never scanned
+/// @note  the indexes run freely, the storage size is a power of two
+typedef struct
+{
+    uint32_t nMagic;       // LIBCB_FILE_MAGIC
+    uint32_t nVersion;     // LIBCB_FILE_VERSION of the creator
+    uint32_t nBufferSize;  // Size of the storage in bytes
+    uint32_t nFlags;       // Operating mode (LIBCB_FILE_FLAG_*)
+    uint32_t nDataOffset;  // Offset of the storage from the start of the file, a page
+    uint32_t nLockWord;    // Spinlock between threads, cleared by an exclusive open
+    uint64_t nGeneration;  // Incremented by every open and every header update
+    uint32_t nHead;        // Index of the next byte to be read
+    uint32_t nTail;        // Index of the next byte to be written
+    uint32_t nLastRecord;  // Index of the newest record, nTail if it is unknown
+} CircularBufferFileHeader;
+
+/// @brief this structure is the open handle of a file-backed circular buffer
+typedef struct
+{
+    CircularBufferFileHeader *pHeader; // Start of the mapping
+    uint8_t *pData;                    // Start of the storage
+    uint32_t nMapSize;                 // Size of the mapping
+    uint32_t nSyncPolicy;              // LIBCB_FILE_SYNC_*
+    uint32_t nPageSize;                // Granularity of msync
+    uint32_t nDiscarded;               // Bytes of a torn record dropped by the last open
+    int32_t nFd;                       // Descriptor holding the shared flock of this handle
+} CircularBufferFile;
+
+/// @brief this function opens a file-backed circular buffer, the file is created
+///        if it does not exist, otherwise the state is restored from its header
+/// @param self pointer to the handle
+/// @param pPath path of the file
+/// @param nBufferSize size of the storage of a new file, rounded up to a power of two
+/// @param nFlags mode of a new file, LIBCB_FILE_FLAG_NONE or LIBCB_FILE_FLAG_RECORD
+/// @param nSyncPolicy LIBCB_FILE_SYNC_*
+/// @note  in record mode the newest record is checked against its CRC32C and
+///        dropped if the write was torn, nDiscarded reports its size
+/// @note  every handle holds a shared flock until it is closed, only an open
+///        that finds no other handle formats a file without a magic, clears
+///        the spinlock and drops a torn record, a holder of the lock that dies
+///        blocks the other handles until all of them are closed
+/// @return LIBCB_INVALIDPARAM if the file is not a valid circular buffer,
+///         LIBCB_SYSTEMERROR with errno set if it cannot be opened or mapped
+int32_t circularBufferFileOpen(CircularBufferFile *self, const char *pPath, uint32_t nBufferSize, uint32_t nFlags, uint32_t nSyncPolicy);
+
+/// @brief this function flushes and unmaps the file-backed circular buffer
+/// @param self pointer to the handle
+/// @return
+int32_t circularBufferFileClose(CircularBufferFile *self);
+
+/// @brief this function synchronously writes the data and then the header to
+///        the file, whatever the sync policy is
+/// @param self pointer to the handle
+/// @return LIBCB_SYSTEMERROR with errno set if msync fails
+int32_t circularBufferFileFlush(CircularBufferFile *self);
+
+/// @brief this function copies the source into the file-backed circular buffer
+/// @param self pointer to the handle, not in LIBCB_FILE_FLAG_RECORD mode
+/// @param pSource pointer to the source buffer
+/// @param nSourceSize number of bytes to push
+/// @return LIBCB_BUFFEROVERFLOW if there is not enough free space
+int32_t circularBufferFilePush(CircularBufferFile *self, const void *pSource, uint32_t nSourceSize);
+
+/// @brief this function copies the oldest bytes out of the file-backed circular buffer
+/// @param self pointer to the handle, not in LIBCB_FILE_FLAG_RECORD mode
+/// @param pDestination pointer to the destination buffer
+/// @param nDestinationSize number of bytes to pop
+/// @return LIBCB_BUFFEREMPTY or LIBCB_BUFFERUNDERFLOW if there is not enough data
+int32_t circularBufferFilePop(CircularBufferFile *self, void *pDestination, uint32_t nDestinationSize);
+
+/// @brief this function stores the source as one record with its CRC32C
+/// @param self pointer to the handle, in LIBCB_FILE_FLAG_RECORD mode
+/// @param pSource pointer to the record
+/// @param nSourceSize size of the record
+/// @return LIBCB_BUFFEROVERFLOW if the record and its header do not fit
+int32_t circularBufferFilePushRecord(CircularBufferFile *self, const void *pSource, uint32_t nSourceSize);
+
+/// @brief this function removes the oldest record and copies it into the destination
+/// @param self pointer to the handle, in LIBCB_FILE_FLAG_RECORD mode
+/// @param pDestination pointer to the destination buffer
+/// @param nDestinationSize size of the destination buffer
+/// @param pnSize receives the size of the record, may be NULL
+/// @return LIBCB_BUFFEROVERFLOW if the record does not fit the destination, it
+///         stays in the buffer then, LIBCB_BUFFEREMPTY if there is no record
+int32_t circularBufferFilePopRecord(CircularBufferFile *self, void *pDestination, uint32_t nDestinationSize, uint32_t *pnSize);
+
+/// @brief this function returns the number of bytes currently stored
+/// @param self pointer to the handle
+/// @return
+int32_t circularBufferFileGetCount(CircularBufferFile *self);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INCLUDED_LIBCIRCULARBUFFERFILE_H
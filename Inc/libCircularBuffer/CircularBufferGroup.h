@@ -0,0 +1,126 @@
+#ifndef INCLUDED_LIBCIRCULARBUFFERGROUP_H
+#define INCLUDED_LIBCIRCULARBUFFERGROUP_H
+
+#include "CircularBufferExt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LIBCB_GROUP_FLAG_NONE   0x00000000u // Consumers pop from any ring concurrently
+#define LIBCB_GROUP_FLAG_FIFO   0x00000001u // A consumer claims a ring until it releases it
+
+/// @brief this struct is one ring of a group with the claim word of
+///        LIBCB_GROUP_FLAG_FIFO on its own cache line
+typedef struct
+{
+    CircularBuffer ring; // Record ring of one producer
+    uint32_t nClaim;     // Consumer holding the ring plus one, 0 if it is free
+    uint8_t aPad[LIBCB_CACHELINE - sizeof(uint32_t)];
+} CircularBufferGroupMember;
+
+/// @brief this struct defines the initialization parameters of the ring group
+typedef struct
+{
+    void *pBuffer;                       // Storage, split evenly between the rings
+    uint32_t nBufferSize;                // Size of the storage in bytes
+    CircularBufferGroupMember *aMembers; // nRingCount members, set up by the group
+    uint32_t nRingCount;                 // Number of rings, usually one per producer
+    uint32_t nFlags;                     // LIBCB_GROUP_FLAG_*
+} CircularBufferGroupInit;
+
+/// @brief this structure defines a group of record rings, one per producer
+/// @note  every ring has its own TTAS lock and its own indexes, a producer only
+///        meets the consumers that pop from its ring, never the other producers
+/// @note  a consumer drains its home ring first and steals from the next
+///        non-empty ring in round-robin order once its home ring is empty
+typedef struct
+{
+    CircularBufferGroupInit init; // Initialization parameters
+    uint32_t nRingSize;           // Storage bytes of every ring
+} CircularBufferGroup;
+
+/// @brief this function initializes the group and its rings in LIBCB_FLAG_RECORD mode
+/// @param self pointer to the group
+/// @param init initialize parameter of the group
+/// @note  every ring gets nBufferSize / nRingCount bytes rounded down to whole
+///        cache lines so neighbouring rings never share one
+/// @return LIBCB_INVALIDPARAM if a ring would be too small for a record header
+int32_t circularBufferGroupInitialize(CircularBufferGroup *self, CircularBufferGroupInit init);
+
+/// @brief this function releases the rings of the group
+/// @param self pointer to the group
+/// @return
+int32_t circularBufferGroupDeinitialize(CircularBufferGroup *self);
+
+/// @brief this function stores the source as one record in the ring of the producer
+/// @param self pointer to the group
+/// @param nProducer index of the producer, its ring is nProducer % nRingCount
+/// @param pSource pointer to the record
+/// @param nSourceSize size of the record
+/// @return LIBCB_BUFFEROVERFLOW if the ring of the producer is full
+int32_t circularBufferGroupPush(CircularBufferGroup *self, uint32_t nProducer, const void *pSource, uint32_t nSourceSize);
+
+/// @brief this function removes the oldest record of the home ring of the
+///        consumer, or of the first other ring that holds one
+/// @param self pointer to the group
+/// @param nConsumer index of the consumer below UINT32_MAX, its home ring is nConsumer % nRingCount
+/// @param pDestination pointer to the destination buffer
+/// @param nDestinationSize size of the destination buffer
+/// @param pnSize receives the size of the record, may be NULL
+/// @param pnRing receives the ring the record came from, may be NULL
+/// @note  with LIBCB_GROUP_FLAG_FIFO rings claimed by other consumers are
+///        skipped and the ring popped from stays claimed by this consumer until
+///        circularBufferGroupRelease, so the records of one producer are never
+///        processed by two consumers at the same time
+/// @return LIBCB_BUFFEREMPTY if no ring available to the consumer holds a record,
+///         LIBCB_BUFFEROVERFLOW if the record does not fit the destination,
+///         LIBCB_INVALIDPARAM if nConsumer is UINT32_MAX
+int32_t circularBufferGroupPop(
+    CircularBufferGroup *self,
+    uint32_t nConsumer,
+    void *pDestination,
+    uint32_t nDestinationSize,
+    uint32_t *pnSize,
+    uint32_t *pnRing
+);
+
+/// @brief this function removes a batch of records from one ring with a single
+///        lock acquisition, the home ring first, otherwise the batch is stolen
+///        from the first other ring that holds a record
+/// @param self pointer to the group
+/// @param nConsumer index of the consumer below UINT32_MAX, its home ring is nConsumer % nRingCount
+/// @param aDestinations buffers to fill, each receives one record and nSize is
+///        set to the size of that record
+/// @param nDestinationCount number of buffers
+/// @param pnRing receives the ring the batch came from, may be NULL
+/// @note  claims rings like circularBufferGroupPop with LIBCB_GROUP_FLAG_FIFO
+/// @return number of records, LIBCB_BUFFEREMPTY if no ring available to the
+///         consumer holds a record that fits the first buffer
+int32_t circularBufferGroupPopv(
+    CircularBufferGroup *self,
+    uint32_t nConsumer,
+    CircularBufferSpan *aDestinations,
+    uint32_t nDestinationCount,
+    uint32_t *pnRing
+);
+
+/// @brief this function gives up the claim of the consumer on the ring, once
+///        the records taken from it have been processed
+/// @param self pointer to the group, initialized with LIBCB_GROUP_FLAG_FIFO
+/// @param nConsumer index of the consumer below UINT32_MAX
+/// @param nRing ring returned by circularBufferGroupPop or circularBufferGroupPopv
+/// @return LIBCB_INVALIDPARAM if the consumer does not hold the ring
+int32_t circularBufferGroupRelease(CircularBufferGroup *self, uint32_t nConsumer, uint32_t nRing);
+
+/// @brief this function returns the number of bytes stored in all rings,
+///        record headers included, the value is only a snapshot
+/// @param self pointer to the group
+/// @return
+int32_t circularBufferGroupGetCount(CircularBufferGroup *self);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INCLUDED_LIBCIRCULARBUFFERGROUP_H
@@ -0,0 +1,75 @@
+#ifndef INCLUDED_LIBCIRCULARBUFFERMPMC_H
+#define INCLUDED_LIBCIRCULARBUFFERMPMC_H
+
+#include "CircularBuffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LIBCB_MPMC_CACHELINE    LIBCB_CACHELINE
+
+/// @brief this struct defines the initialization parameters of the
+///        multi-producer/multi-consumer circular buffer
+typedef struct
+{
+    void *pBuffer;           // Pointer to the slot storage, 8 byte aligned
+    uint32_t nBufferSize;    // Size of the slot storage in bytes
+    uint32_t nElementSize;   // Maximum bytes of a single element
+} CircularBufferMpmcInit;
+
+/// @brief this structure defines the multi-producer/multi-consumer circular buffer
+/// @note  the storage is split into a power of two number of slots, every slot
+///        carries a sequence number (Vyukov) so producers and consumers only
+///        contend on their own position counter and never take a lock
+typedef struct
+{
+    CircularBufferMpmcInit init; // Initialization parameters
+    uint32_t nSlotSize;          // Bytes of a slot including its header
+    uint32_t nSlotMask;          // Number of slots minus one
+    uint8_t aPad0[LIBCB_MPMC_CACHELINE];
+    uint32_t nEnqueuePos;        // Next slot to be claimed by a producer
+    uint8_t aPad1[LIBCB_MPMC_CACHELINE - sizeof(uint32_t)];
+    uint32_t nDequeuePos;        // Next slot to be claimed by a consumer
+    uint8_t aPad2[LIBCB_MPMC_CACHELINE - sizeof(uint32_t)];
+} CircularBufferMpmc;
+
+/// @brief this function initializes the multi-producer/multi-consumer circular buffer
+/// @param self pointer to the circular buffer
+/// @param init initialize parameter of the circular buffer
+/// @return
+int32_t circularBufferMpmcInitialize(CircularBufferMpmc *self, CircularBufferMpmcInit init);
+
+/// @brief this function copies one element from the source into a free slot,
+///        it is safe to call from any number of threads
+/// @param self
+/// @param pSource
+/// @param nSourceSize must not exceed nElementSize
+/// @return LIBCB_BUFFEROVERFLOW if no slot is free
+int32_t circularBufferMpmcPush(CircularBufferMpmc *self, const void *pSource, uint32_t nSourceSize);
+
+/// @brief this function copies the oldest element into the destination,
+///        it is safe to call from any number of threads
+/// @param self
+/// @param pDestination
+/// @param nDestinationSize must be at least nElementSize
+/// @param pnSize receives the size of the element, may be NULL
+/// @return LIBCB_BUFFEREMPTY if no element is available
+int32_t circularBufferMpmcPop(CircularBufferMpmc *self, void *pDestination, uint32_t nDestinationSize, uint32_t *pnSize);
+
+/// @brief this function returns the number of slots of the circular buffer
+/// @param self
+/// @return
+int32_t circularBufferMpmcGetCapacity(CircularBufferMpmc *self);
+
+/// @brief this function returns the number of elements currently stored,
+///        the value is only a snapshot while other threads are active
+/// @param self
+/// @return
+int32_t circularBufferMpmcGetCount(CircularBufferMpmc *self);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INCLUDED_LIBCIRCULARBUFFERMPMC_H
@@ -0,0 +1,103 @@
+#ifndef INCLUDED_LIBCIRCULARBUFFERSHM_H
+#define INCLUDED_LIBCIRCULARBUFFERSHM_H
+
+#include "CircularBuffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LIBCB_SHM_MAGIC         0x42435348u // "HSCB"
+#define LIBCB_SHM_VERSION       1u
+
+#define LIBCB_SHM_FLAG_NONE     0x00000000u // Any number of processes, process-shared spinlock
+#define LIBCB_SHM_FLAG_SPSC     0x00000001u // One producer and one consumer process, lock-free
+
+/// @brief this struct is the control block at the start of the shared mapping,
+///        it only holds offsets and indexes so every process can map it anywhere
+/// @note  the indexes run freely, the storage size is a power of two
+typedef struct
+{
+    uint32_t nMagic;      // LIBCB_SHM_MAGIC once the creator finished the setup
+    uint32_t nVersion;    // LIBCB_SHM_VERSION of the creator
+    uint32_t nBufferSize; // Size of the storage in bytes
+    uint32_t nFlags;      // Operating mode (LIBCB_SHM_FLAG_*)
+    uint32_t nDataOffset; // Offset of the storage from the start of the mapping
+    uint32_t nLockWord;   // Process-shared spinlock of LIBCB_SHM_FLAG_NONE
+    uint8_t aPad0[LIBCB_CACHELINE];
+    uint32_t nTail;       // Index of the next byte to be written
+    uint8_t aPad1[LIBCB_CACHELINE];
+    uint32_t nHead;       // Index of the next byte to be read
+    uint8_t aPad2[LIBCB_CACHELINE];
+} CircularBufferShmHeader;
+
+/// @brief this structure is the view of one process on a shared circular buffer
+/// @note  the geometry and the mode are copied from the header once they are
+///        validated, a peer rewriting the header cannot move this view out of
+///        its mapping
+typedef struct
+{
+    CircularBufferShmHeader *pHeader; // Start of the mapping in this process
+    uint8_t *pData;                   // Start of the storage in this process
+    uint32_t nMapSize;                // Size of the mapping
+    uint32_t nBufferSize;             // Validated size of the storage
+    uint32_t nFlags;                  // Validated operating mode (LIBCB_SHM_FLAG_*)
+    uint32_t nCachedHead;             // Last nHead seen by this producer
+    uint32_t nCachedTail;             // Last nTail seen by this consumer
+} CircularBufferShm;
+
+/// @brief this function creates a named shared memory object holding the control
+///        block and the storage, and maps it into the calling process
+/// @note  the spinlock of LIBCB_SHM_FLAG_NONE is not robust, a process that dies
+///        while it holds the lock leaves every other process spinning, use
+///        LIBCB_SHM_FLAG_SPSC where a peer may be killed
+/// @param self pointer to the view
+/// @param pName name passed to shm_open, e.g. "/capture"
+/// @param nBufferSize size of the storage, rounded up to a power of two
+/// @param nFlags LIBCB_SHM_FLAG_NONE or LIBCB_SHM_FLAG_SPSC
+/// @return LIBCB_SYSTEMERROR with errno set if the object exists or cannot be created
+int32_t circularBufferShmCreate(CircularBufferShm *self, const char *pName, uint32_t nBufferSize, uint32_t nFlags);
+
+/// @brief this function maps a shared circular buffer created by another process
+/// @param self pointer to the view
+/// @param pName name used by circularBufferShmCreate
+/// @return LIBCB_INVALIDPARAM if the object is not a shared circular buffer of
+///         this version or its creator has not finished the setup yet
+int32_t circularBufferShmAttach(CircularBufferShm *self, const char *pName);
+
+/// @brief this function unmaps the shared circular buffer from the calling process
+/// @param self pointer to the view
+/// @return
+int32_t circularBufferShmDetach(CircularBufferShm *self);
+
+/// @brief this function removes the name, the memory is released with the last mapping
+/// @param pName name used by circularBufferShmCreate
+/// @return
+int32_t circularBufferShmUnlink(const char *pName);
+
+/// @brief this function copies the source into the shared circular buffer
+/// @param self pointer to the view
+/// @param pSource pointer to the source buffer
+/// @param nSourceSize number of bytes to push
+/// @note  with LIBCB_SHM_FLAG_SPSC only one process may push
+/// @return LIBCB_BUFFEROVERFLOW if there is not enough free space
+int32_t circularBufferShmPush(CircularBufferShm *self, const void *pSource, uint32_t nSourceSize);
+
+/// @brief this function copies the oldest bytes out of the shared circular buffer
+/// @param self pointer to the view
+/// @param pDestination pointer to the destination buffer
+/// @param nDestinationSize number of bytes to pop
+/// @note  with LIBCB_SHM_FLAG_SPSC only one process may pop
+/// @return LIBCB_BUFFEREMPTY or LIBCB_BUFFERUNDERFLOW if there is not enough data
+int32_t circularBufferShmPop(CircularBufferShm *self, void *pDestination, uint32_t nDestinationSize);
+
+/// @brief this function returns the number of bytes currently stored
+/// @param self pointer to the view
+/// @return
+int32_t circularBufferShmGetCount(CircularBufferShm *self);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INCLUDED_LIBCIRCULARBUFFERSHM_H
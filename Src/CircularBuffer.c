@@ -1,35 +1,354 @@
 #include <string.h>
-#include "libCircularBuffer/CircularBuffer.h"
+#include "CircularBufferLock.h"
 
-// Lock the mutex
+// Push of circularBufferPush and circularBufferPushCopy with the given kernel
+static int32_t PushWith(CircularBuffer *self, CircularBufferCopyFn pfnCopy, const void *pSource, uint32_t nSourceSize);
+
+// Pop of circularBufferPop and circularBufferPopCopy with the given kernel
+static int32_t PopWith(CircularBuffer *self, CircularBufferCopyFn pfnCopy, void *pDestination, uint32_t nDestinationSize);
+
+// Lock the buffer with the selected lock policy, counted in the lock statistics
 static int32_t Lock(CircularBuffer *self);
 
-// Release the mutex
+// Lock the buffer without counting, for the re-checks inside a public call
+static int32_t LockUncounted(CircularBuffer *self);
+
+// Release the lock taken by Lock
 static int32_t Release(CircularBuffer *self);
 
+// Header value that marks the rest of the buffer as padding
+#define RECORD_PADDING 0xFFFFFFFFu
+
+// Convert a head or tail index into a byte offset of the buffer
+static uint32_t IndexToOffset(const CircularBuffer *self, uint32_t nIndex);
+
+// Advance a head or tail index by the given number of bytes
+static uint32_t IndexAdvance(const CircularBuffer *self, uint32_t nIndex, uint32_t nSize);
+
+// Number of bytes between two lock-free indexes
+static uint32_t IndexDistance(const CircularBuffer *self, uint32_t nHead, uint32_t nTail);
+
+// Number of bytes currently stored, valid in every mode
+static uint32_t GetUsed(CircularBuffer *self);
+
+// Advance the tail of a locked buffer and account for the added bytes
+static void MoveTail(CircularBuffer *self, uint32_t nSize);
+
+// Advance the head of a locked buffer and account for the removed bytes
+static void MoveHead(CircularBuffer *self, uint32_t nSize);
+
+// Copy into the buffer with the kernel starting at the byte offset, wrapping if needed
+static void CopyToBuffer(CircularBuffer *self, CircularBufferCopyFn pfnCopy, uint32_t nOffset, const void *pSource, uint32_t nSize);
+
+// Copy out of the buffer with the kernel starting at the byte offset, wrapping if needed
+static void CopyFromBuffer(CircularBuffer *self, CircularBufferCopyFn pfnCopy, uint32_t nOffset, void *pDestination, uint32_t nSize);
+
+// Split nSize bytes starting at the byte offset into the spans before and after the wrap
+static void GetSpans(CircularBuffer *self, uint32_t nOffset, uint32_t nSize, CircularBufferSpan aSpans[2]);
+
+// Copy to the buffer and continue the CRC32C of the source in the same pass
+static uint32_t CopyToBufferCrc(CircularBuffer *self, uint32_t nOffset, const void *pSource, uint32_t nSize, uint32_t nCrc);
+
+// Copy from the buffer and continue the CRC32C of the data in the same pass
+static uint32_t CopyFromBufferCrc(CircularBuffer *self, uint32_t nOffset, void *pDestination, uint32_t nSize, uint32_t nCrc);
+
+// Fold the bytes already stored at the offset into the running CRC of LIBCB_FLAG_CRC
+static void FoldPushedCrc(CircularBuffer *self, uint32_t nOffset, uint32_t nSize);
+
+// Search the two spans for the pattern, returns the position or LIBCB_NOTFOUND
+static int32_t SearchSpans(const CircularBufferSpan aSpans[2], const uint8_t *pPattern, uint32_t nPatternSize);
+
+// Compare the pattern with the spans from the given position on
+static uint8_t MatchSpans(const CircularBufferSpan aSpans[2], uint32_t nPosition, const uint8_t *pPattern, uint32_t nPatternSize);
+
+// Write a record at the tail index if it fits into nFree bytes, pnWritten includes padding
+static int32_t WriteRecord(CircularBuffer *self, uint32_t nTail, uint32_t nFree, const void *pSource, uint32_t nSize, uint32_t *pnWritten);
+
+// Locate the record at the head index, pnSkip receives the padding in front of its header
+static int32_t ParseRecord(CircularBuffer *self, uint32_t nHead, uint32_t nUsed, uint32_t *pnSkip, uint32_t *pnSize);
+
+// Drop the oldest data until nRequired bytes are free, whole records in record mode
+static void DropOldest(CircularBuffer *self, uint32_t nRequired);
+
+// Wake consumers parked in circularBufferPopWait after data was added
+static void NotifyPushed(CircularBuffer *self);
+
+// Wake producers parked in circularBufferPushWait after space was freed
+static void NotifyPopped(CircularBuffer *self);
+
+// Arm the readable eventfd after a consumer failed for lack of nRequired bytes
+static void ArmReadable(CircularBuffer *self, uint32_t nRequired);
+
+// Arm the writable eventfd after a producer failed for lack of nRequired bytes
+static void ArmWritable(CircularBuffer *self, uint32_t nRequired);
+
+// Announce a waiter and sample the futex word it is going to park on
+static uint32_t BeginWait(uint32_t *pSequence, uint32_t *pWaiters);
+
+// Load the head published by the consumer and cache it for the producer
+static uint32_t LoadHead(CircularBuffer *self);
+
+// Load the tail published by the producer and cache it for the consumer
+static uint32_t LoadTail(CircularBuffer *self);
+
+// Account a producer call that moved the tail by nSize bytes and track the high-water mark
+static void CountPushed(CircularBuffer *self, uint32_t nSize);
+
+// Account a consumer call that moved the head by nSize bytes
+static void CountPopped(CircularBuffer *self, uint32_t nSize);
+
+// Account a producer call rejected for lack of space
+static void CountOverflow(CircularBuffer *self);
+
+// Account a consumer call rejected for lack of data
+static void CountUnderflow(CircularBuffer *self);
+
+#ifdef LIBCB_ENABLE_STATISTICS
+// Account one acquisition of the lock that started at nStart
+static void CountLockWait(CircularBuffer *self, uint64_t nStart);
+
+// Read a statistics counter, clearing it on request
+static uint64_t ReadCounter(uint64_t *pnCounter, uint8_t bReset);
+#endif
+
+// Push for the single-producer/single-consumer mode
+static int32_t PushLockFree(CircularBuffer *self, CircularBufferCopyFn pfnCopy, const void *pSource, uint32_t nSourceSize);
+
+// Pop for the single-producer/single-consumer mode
+static int32_t PopLockFree(CircularBuffer *self, CircularBufferCopyFn pfnCopy, void *pDestination, uint32_t nDestinationSize);
+
+// Move the stored data unwrapped to the front of new storage, the caller holds the lock
+static int32_t MoveStorage(CircularBuffer *self, void *pBuffer, uint32_t nBufferSize);
+
+// Move to storage of the resize policy and free the old one
+static int32_t Reallocate(CircularBuffer *self, uint32_t nBufferSize);
+
+// Grow the storage under the resize policy until nFree more bytes fit
+static int32_t Grow(CircularBuffer *self, uint32_t nFree);
+
+// Halve the storage once the count stayed low for nShrinkAfter pops
+static void Shrink(CircularBuffer *self, uint32_t nUsed);
+
 int32_t circularBufferInitialize(CircularBuffer *self, CircularBufferInit init)
+{
+    return circularBufferInitializeWithFlags(self, init, LIBCB_FLAG_NONE);
+}
+
+int32_t circularBufferInitializeWithFlags(CircularBuffer *self, CircularBufferInit init, uint32_t nFlags)
 {
     int32_t status = LIBCB_SUCCESS;
 
+    // callers written before the modes existed never set the field
+    init.nFlags = nFlags;
+
     for (;;)
     {
-        if (self == NULL || init.nBufferSize == 0 || init.pBuffer == NULL)
+        if (self == NULL || init.nBufferSize == 0)
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        // a mirrored buffer is allocated here, any other has to be supplied
+        if ((init.pBuffer == NULL) != ((init.nFlags & LIBCB_FLAG_MIRRORED) != 0))
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        CircularBufferCopyFn pfnCopy = NULL, pfnCopyOut = NULL;
+
+        status = circularBufferCopySelect(init.nFlags, &pfnCopy);
+
+        if (status == LIBCB_SUCCESS)
+        {
+            status = circularBufferCopySelectOut(init.nFlags, &pfnCopyOut);
+        }
+
+        if (status != LIBCB_SUCCESS)
+        {
+            break;
+        }
+
+        if (init.nFlags & LIBCB_FLAG_POWEROFTWO)
+        {
+            if (init.nFlags & LIBCB_FLAG_MIRRORED)
+            {
+                if (init.nBufferSize > 0x80000000u)
+                {
+                    status = LIBCB_INVALIDPARAM;
+                    break;
+                }
+
+                // the page rounding of the mapping keeps a power of two intact
+                init.nBufferSize--;
+                init.nBufferSize |= init.nBufferSize >> 1;
+                init.nBufferSize |= init.nBufferSize >> 2;
+                init.nBufferSize |= init.nBufferSize >> 4;
+                init.nBufferSize |= init.nBufferSize >> 8;
+                init.nBufferSize |= init.nBufferSize >> 16;
+                init.nBufferSize++;
+            }
+            else
+            {
+                // never use more of the supplied storage than there is
+                while (init.nBufferSize & (init.nBufferSize - 1))
+                {
+                    init.nBufferSize &= init.nBufferSize - 1;
+                }
+            }
+        }
+
+        if (
+            ((init.nFlags & LIBCB_FLAG_RECORDNOWRAP) && !(init.nFlags & LIBCB_FLAG_RECORD)) ||
+            ((init.nFlags & LIBCB_FLAG_RECORDCRC) && !(init.nFlags & LIBCB_FLAG_RECORD)) ||
+            // the mapping rounds a mirrored size up to whole pages, anything
+            // smaller would wrap the largest payload WriteRecord computes
+            ((init.nFlags & (LIBCB_FLAG_RECORD | LIBCB_FLAG_RECORDCRC)) && !(init.nFlags & LIBCB_FLAG_MIRRORED) &&
+                init.nBufferSize <= LIBCB_RECORD_HEADER_SIZE + LIBCB_RECORD_CRC_SIZE)
+            )
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        // only a locked producer may move the head of the consumer
+        if ((init.nFlags & LIBCB_FLAG_OVERWRITE) && (init.nFlags & LIBCB_FLAG_SPSC))
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        if ((init.nFlags & LIBCB_FLAG_LOCKMASK) > LIBCB_FLAG_LOCKADAPTIVE)
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        // lock-free indexes run up to twice the size to tell full from empty
+        if ((init.nFlags & LIBCB_FLAG_SPSC) && init.nBufferSize > 0x80000000u)
         {
             status = LIBCB_INVALIDPARAM;
             break;
         }
 
+        // every check is done before the mapping, a rejected mode allocates nothing
+        if (init.nFlags & LIBCB_FLAG_MIRRORED)
+        {
+            status = circularBufferMirrorAllocate(&init.nBufferSize, &init.pBuffer);
+
+            if (status != LIBCB_SUCCESS)
+            {
+                break;
+            }
+        }
+
         self->init = init;
+        self->pfnCopy = pfnCopy;
+        self->pfnCopyOut = pfnCopyOut;
+        self->pResizePolicy = NULL;
+        self->nResizePeak = 0;
+        self->nResizePops = 0;
         self->nCount = 0;
+        self->nLockWord = 0;
+        self->nLockTicket = 0;
+        self->nLockServing = 0;
         self->nHead = 0;
         self->nTail = 0;
+        self->nCachedHead = 0;
+        self->nCachedTail = 0;
+        self->nReserved = 0;
+        self->nPeeked = 0;
+        self->nPushSequence = 0;
+        self->nPopSequence = 0;
+        self->nPushWaiters = 0;
+        self->nPopWaiters = 0;
+        self->nDroppedBytes = 0;
+        self->nDroppedRecords = 0;
+        self->nPushedCrc = 0;
+        self->nReadableFd = -1;
+        self->nWritableFd = -1;
+        // a consumer of the readable eventfd starts out waiting for data
+        self->nReadArmed = (init.nFlags & LIBCB_FLAG_EVENTFD) ? 1 : 0;
+        self->nWriteArmed = 0;
         self->pMutex = NULL;
+#ifdef LIBCB_ENABLE_STATISTICS
+        self->nStatLockAcquires = 0;
+        self->nStatLockWaitNs = 0;
+        self->nStatLockWaitMaxNs = 0;
+        self->nStatPushedBytes = 0;
+        self->nStatPushes = 0;
+        self->nStatOverflows = 0;
+        self->nStatHighWater = 0;
+        self->nStatPoppedBytes = 0;
+        self->nStatPops = 0;
+        self->nStatUnderflows = 0;
+#endif
+
+        // a new buffer is writable and waits for its first push to be readable
+        if (init.nFlags & LIBCB_FLAG_EVENTFD)
+        {
+            status = circularBufferEventOpen(0, &self->nReadableFd);
+
+            if (status == LIBCB_SUCCESS)
+            {
+                status = circularBufferEventOpen(1, &self->nWritableFd);
+            }
+
+            // closes the descriptor that did open and unmaps a mirrored buffer
+            if (status != LIBCB_SUCCESS)
+            {
+                circularBufferDeinitialize(self);
+                break;
+            }
+        }
+
+        if (
+            init.pfnMutexInitialize != NULL &&
+            (init.nFlags & LIBCB_FLAG_LOCKMASK) == LIBCB_FLAG_LOCKCALLBACK &&
+            !(init.nFlags & LIBCB_FLAG_SPSC) &&
+            init.pfnMutexInitialize(&self->pMutex) != 0
+            )
+        {
+            // the caller cannot deinitialize a buffer that failed to initialize
+            circularBufferDeinitialize(self);
+            status = LIBCB_MUTEXERROR;
+        }
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t circularBufferDeinitialize(CircularBuffer *self)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (self == NULL)
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        if (self->init.nFlags & LIBCB_FLAG_MIRRORED)
+        {
+            status = circularBufferMirrorFree(self->init.pBuffer, self->init.nBufferSize);
+        }
 
-        if (init.pfnMutexInitialize != NULL)
+        if (self->init.nFlags & LIBCB_FLAG_EVENTFD)
         {
-            init.pfnMutexInitialize(&self->pMutex);
+            circularBufferEventClose(self->nReadableFd);
+            circularBufferEventClose(self->nWritableFd);
+            self->nReadableFd = -1;
+            self->nWritableFd = -1;
         }
 
+        self->init.pBuffer = NULL;
+        self->init.nBufferSize = 0;
+
         break;
     }
 
@@ -51,122 +370,269 @@ int32_t circularBufferFlush(CircularBuffer *self)
         self->nCount = 0;
         self->nHead = 0;
         self->nTail = 0;
+        self->nCachedHead = 0;
+        self->nCachedTail = 0;
+        self->nReserved = 0;
+        self->nPeeked = 0;
 
         break;
     }
 
+    if (status == LIBCB_SUCCESS)
+    {
+        NotifyPopped(self);
+    }
+
     return status;
 }
 
 int32_t circularBufferPush(CircularBuffer *self, void *pSource, uint32_t nSourceSize)
+{
+    return PushWith(self, self != NULL ? self->pfnCopy : NULL, pSource, nSourceSize);
+}
+
+int32_t circularBufferPop(CircularBuffer *self, void *pDestination, uint32_t nDestinationSize)
+{
+    return PopWith(self, self != NULL ? self->pfnCopyOut : NULL, pDestination, nDestinationSize);
+}
+
+int32_t circularBufferPushCopy(CircularBuffer *self, void *pSource, uint32_t nSourceSize, uint32_t nCopy)
+{
+    CircularBufferCopyFn pfnCopy = NULL;
+    int32_t status = circularBufferCopySelect(nCopy, &pfnCopy);
+
+    if (status == LIBCB_SUCCESS)
+    {
+        status = PushWith(self, pfnCopy, pSource, nSourceSize);
+    }
+
+    return status;
+}
+
+int32_t circularBufferPopCopy(CircularBuffer *self, void *pDestination, uint32_t nDestinationSize, uint32_t nCopy)
+{
+    CircularBufferCopyFn pfnCopy = NULL;
+    int32_t status = circularBufferCopySelectOut(nCopy, &pfnCopy);
+
+    if (status == LIBCB_SUCCESS)
+    {
+        status = PopWith(self, pfnCopy, pDestination, nDestinationSize);
+    }
+
+    return status;
+}
+
+int32_t PushWith(CircularBuffer *self, CircularBufferCopyFn pfnCopy, const void *pSource, uint32_t nSourceSize)
 {
     int32_t status = LIBCB_SUCCESS;
 
     for (;;)
     {
+        // checked outside the lock one field at a time, neither is used before Lock
         if (
-            self == NULL || pSource == NULL ||
-            nSourceSize == 0 || self->init.pBuffer == NULL ||
-            self->init.nBufferSize == 0
+            self == NULL || pfnCopy == NULL || pSource == NULL || nSourceSize == 0 ||
+            __atomic_load_n(&self->init.pBuffer, __ATOMIC_RELAXED) == NULL ||
+            __atomic_load_n(&self->init.nBufferSize, __ATOMIC_RELAXED) == 0
             )
         {
             status = LIBCB_INVALIDPARAM;
             break;
         }
 
-        if (self->init.nBufferSize < nSourceSize)
+        if (self->init.nFlags & LIBCB_FLAG_SPSC)
+        {
+            status = PushLockFree(self, pfnCopy, pSource, nSourceSize);
+            break;
+        }
+
+        status = Lock(self);
+
+        if (status != LIBCB_SUCCESS)
         {
-            status = LIBCB_BUFFEROVERFLOW;
             break;
         }
 
-        Lock(self);
+        // a larger storage keeps the data an overwriting buffer would drop
+        if (self->pResizePolicy != NULL && self->init.nBufferSize - GetUsed(self) < nSourceSize)
+        {
+            Grow(self, nSourceSize);
+        }
+
+        if ((self->init.nFlags & LIBCB_FLAG_OVERWRITE) && nSourceSize <= self->init.nBufferSize)
+        {
+            DropOldest(self, nSourceSize);
+        }
 
-        if (self->init.nBufferSize < (self->nCount + nSourceSize))
+        if (self->init.nBufferSize - GetUsed(self) < nSourceSize)
         {
             Release(self);
             status = LIBCB_BUFFEROVERFLOW;
             break;
         }
 
-        if (self->nTail + nSourceSize > self->init.nBufferSize)
+        if (self->init.nFlags & LIBCB_FLAG_CRC)
         {
-            uint32_t nFirstCopySize = self->init.nBufferSize - self->nTail;
-            uint32_t nSecondCopySize = nSourceSize - nFirstCopySize;
-
-            memcpy((uint8_t *)self->init.pBuffer + self->nTail, pSource, nFirstCopySize);
-            memcpy(self->init.pBuffer, (uint8_t *)pSource + nFirstCopySize, nSecondCopySize);
-            self->nTail = nSecondCopySize;
+            self->nPushedCrc = CopyToBufferCrc(self, IndexToOffset(self, self->nTail), pSource, nSourceSize, self->nPushedCrc);
         }
         else
         {
-            memcpy((uint8_t *)self->init.pBuffer + self->nTail, pSource, nSourceSize);
-            self->nTail += nSourceSize;
+            CopyToBuffer(self, pfnCopy, IndexToOffset(self, self->nTail), pSource, nSourceSize);
         }
 
-        self->nCount += nSourceSize;
+        MoveTail(self, nSourceSize);
+        CountPushed(self, nSourceSize);
 
-        Release(self);
+        status = Release(self);
 
         break;
     }
 
+    if (status == LIBCB_SUCCESS)
+    {
+        NotifyPushed(self);
+    }
+    else if (status == LIBCB_BUFFEROVERFLOW)
+    {
+        CountOverflow(self);
+        ArmWritable(self, nSourceSize);
+    }
+
     return status;
 }
 
-int32_t circularBufferPop(CircularBuffer *self, void *pDestination, uint32_t nDestinationSize)
+int32_t PopWith(CircularBuffer *self, CircularBufferCopyFn pfnCopy, void *pDestination, uint32_t nDestinationSize)
 {
     int32_t status = LIBCB_SUCCESS;
 
     for (;;)
     {
-        if (self == NULL || pDestination == NULL || nDestinationSize == 0)
+        if (self == NULL || pfnCopy == NULL || pDestination == NULL || nDestinationSize == 0)
         {
             status = LIBCB_INVALIDPARAM;
             break;
         }
 
-        if (self->nCount == 0)
+        if (self->init.nFlags & LIBCB_FLAG_SPSC)
         {
-            status = LIBCB_BUFFEREMPTY;
+            status = PopLockFree(self, pfnCopy, pDestination, nDestinationSize);
             break;
         }
 
-        Lock(self);
+        status = Lock(self);
 
-        if (self->nCount < nDestinationSize)
+        if (status != LIBCB_SUCCESS)
         {
-            Release(self);
-            status = LIBCB_BUFFERUNDERFLOW;
             break;
         }
 
-        if (self->nHead + nDestinationSize > self->init.nBufferSize)
+        // the count is only stable under the lock
+        if (GetUsed(self) < nDestinationSize)
         {
-            uint32_t nFirstCopySize = self->init.nBufferSize - self->nHead;
-            uint32_t nSecondCopySize = nDestinationSize - nFirstCopySize;
-
-            memcpy(pDestination, (uint8_t *)self->init.pBuffer + self->nHead, nFirstCopySize);
-            memcpy((uint8_t *)pDestination + nFirstCopySize, self->init.pBuffer, nSecondCopySize);
-            self->nHead = nSecondCopySize;
+            status = GetUsed(self) == 0 ? LIBCB_BUFFEREMPTY : LIBCB_BUFFERUNDERFLOW;
+            Release(self);
+            break;
         }
-        else
+
+        CopyFromBuffer(self, pfnCopy, IndexToOffset(self, self->nHead), pDestination, nDestinationSize);
+
+        MoveHead(self, nDestinationSize);
+        CountPopped(self, nDestinationSize);
+        Shrink(self, GetUsed(self) + nDestinationSize);
+
+        status = Release(self);
+
+        break;
+    }
+
+    if (status == LIBCB_SUCCESS)
+    {
+        NotifyPopped(self);
+    }
+    else if (status == LIBCB_BUFFEREMPTY || status == LIBCB_BUFFERUNDERFLOW)
+    {
+        CountUnderflow(self);
+        ArmReadable(self, nDestinationSize);
+    }
+
+    return status;
+}
+
+int32_t Lock(CircularBuffer *self)
+{
+    int32_t status;
+#ifdef LIBCB_ENABLE_STATISTICS
+    uint64_t nStart = circularBufferMonotonicTime();
+#endif
+
+    status = LockUncounted(self);
+
+#ifdef LIBCB_ENABLE_STATISTICS
+    if (status == LIBCB_SUCCESS)
+    {
+        CountLockWait(self, nStart);
+    }
+#endif
+
+    return status;
+}
+
+int32_t LockUncounted(CircularBuffer *self)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    switch (self->init.nFlags & LIBCB_FLAG_LOCKMASK)
+    {
+    case LIBCB_FLAG_LOCKTICKET:
+        TicketLockAcquire(&self->nLockTicket, &self->nLockServing);
+        break;
+    case LIBCB_FLAG_LOCKTTAS:
+        SpinLockAcquire(&self->nLockWord);
+        break;
+    case LIBCB_FLAG_LOCKADAPTIVE:
+        AdaptiveLockAcquire(&self->nLockWord);
+        break;
+    case LIBCB_FLAG_LOCKCALLBACK:
+        if (self->init.pfnMutexLock != NULL && self->init.pfnMutexLock(self->pMutex) != 0)
         {
-            memcpy(pDestination, (uint8_t *)self->init.pBuffer + self->nHead, nDestinationSize);
-            self->nHead += nDestinationSize;
+            status = LIBCB_MUTEXERROR;
         }
+        break;
+    default:
+        break;
+    }
 
-        self->nCount -= nDestinationSize;
+    return status;
+}
 
-        Release(self);
+int32_t Release(CircularBuffer *self)
+{
+    int32_t status = LIBCB_SUCCESS;
 
+    switch (self->init.nFlags & LIBCB_FLAG_LOCKMASK)
+    {
+    case LIBCB_FLAG_LOCKTICKET:
+        TicketLockRelease(&self->nLockServing);
+        break;
+    case LIBCB_FLAG_LOCKTTAS:
+        SpinLockRelease(&self->nLockWord);
+        break;
+    case LIBCB_FLAG_LOCKADAPTIVE:
+        AdaptiveLockRelease(&self->nLockWord);
+        break;
+    case LIBCB_FLAG_LOCKCALLBACK:
+        if (self->init.pfnMutexRelease != NULL && self->init.pfnMutexRelease(self->pMutex) != 0)
+        {
+            status = LIBCB_MUTEXERROR;
+        }
+        break;
+    default:
         break;
     }
 
     return status;
 }
 
-int32_t Lock(CircularBuffer *self)
+int32_t circularBufferGetDropped(CircularBuffer *self, uint64_t *pnBytes, uint64_t *pnRecords)
 {
     int32_t status = LIBCB_SUCCESS;
 
@@ -178,33 +644,60 @@ int32_t Lock(CircularBuffer *self)
             break;
         }
 
-        if (self->init.pfnMutexLock != NULL)
+        status = Lock(self);
+
+        if (status != LIBCB_SUCCESS)
+        {
+            break;
+        }
+
+        if (pnBytes != NULL)
         {
-            self->init.pfnMutexLock(self->pMutex);
+            *pnBytes = self->nDroppedBytes;
         }
 
+        if (pnRecords != NULL)
+        {
+            *pnRecords = self->nDroppedRecords;
+        }
+
+        status = Release(self);
+
         break;
     }
 
     return status;
 }
 
-int32_t Release(CircularBuffer *self)
+int32_t circularBufferGetStatistics(CircularBuffer *self, CircularBufferStatistics *pStatistics, uint8_t bReset)
 {
     int32_t status = LIBCB_SUCCESS;
 
     for (;;)
     {
-        if (self == NULL)
+        if (self == NULL || pStatistics == NULL)
         {
             status = LIBCB_INVALIDPARAM;
             break;
         }
 
-        if (self->init.pfnMutexRelease != NULL)
-        {
-            self->init.pfnMutexRelease(self->pMutex);
-        }
+#ifdef LIBCB_ENABLE_STATISTICS
+        pStatistics->nPushedBytes = ReadCounter(&self->nStatPushedBytes, bReset);
+        pStatistics->nPushes = ReadCounter(&self->nStatPushes, bReset);
+        pStatistics->nPoppedBytes = ReadCounter(&self->nStatPoppedBytes, bReset);
+        pStatistics->nPops = ReadCounter(&self->nStatPops, bReset);
+        pStatistics->nOverflows = ReadCounter(&self->nStatOverflows, bReset);
+        pStatistics->nUnderflows = ReadCounter(&self->nStatUnderflows, bReset);
+        pStatistics->nLockAcquires = ReadCounter(&self->nStatLockAcquires, bReset);
+        pStatistics->nLockWaitNs = ReadCounter(&self->nStatLockWaitNs, bReset);
+        pStatistics->nLockWaitMaxNs = ReadCounter(&self->nStatLockWaitMaxNs, bReset);
+        pStatistics->nHighWater = bReset ?
+            __atomic_exchange_n(&self->nStatHighWater, 0, __ATOMIC_RELAXED) :
+            __atomic_load_n(&self->nStatHighWater, __ATOMIC_RELAXED);
+#else
+        (void)bReset;
+        status = LIBCB_NOTSUPPORTED;
+#endif
 
         break;
     }
@@ -224,7 +717,7 @@ int32_t circularBufferIsEmpty(CircularBuffer *self)
             break;
         }
 
-        if (self->nCount == 0)
+        if (GetUsed(self) == 0)
         {
             status = TRUE;
             break;
@@ -250,7 +743,7 @@ int32_t circularBufferIsFull(CircularBuffer *self)
             break;
         }
 
-        if (self->nCount == self->init.nBufferSize)
+        if (GetUsed(self) == __atomic_load_n(&self->init.nBufferSize, __ATOMIC_RELAXED))
         {
             status = TRUE;
             break;
@@ -276,7 +769,8 @@ int32_t circularBufferGetCapacity(CircularBuffer *self)
             break;
         }
 
-        status = self->init.nBufferSize;
+        // circularBufferResize stores the size atomically under the lock
+        status = __atomic_load_n(&self->init.nBufferSize, __ATOMIC_RELAXED);
 
         break;
     }
@@ -296,7 +790,7 @@ int32_t circularBufferGetCount(CircularBuffer *self)
             break;
         }
 
-        status = self->nCount;
+        status = GetUsed(self);
 
         break;
     }
@@ -322,39 +816,2263 @@ int32_t circularBufferRead(
             break;
         }
 
-        if (self->nCount == 0)
+        uint32_t nUsed = GetUsed(self);
+
+        if (nUsed == 0)
         {
             status = LIBCB_BUFFEREMPTY;
             break;
         }
 
-        if (nStartOffset + nCount > self->nCount)
+        if (nStartOffset + nCount > nUsed)
         {
             status = LIBCB_BUFFERUNDERFLOW;
             break;
         }
 
-        Lock(self);
+        if (self->init.nFlags & LIBCB_FLAG_SPSC)
+        {
+            // only the consumer moves the head, so it is stable for the reader
+            uint32_t nHead = __atomic_load_n(&self->nHead, __ATOMIC_RELAXED);
+            uint32_t nOffset = IndexToOffset(self, IndexAdvance(self, nHead, nStartOffset));
+
+            CopyFromBuffer(self, self->pfnCopyOut, nOffset, pDestination, nCount);
+            break;
+        }
 
-        uint32_t nHead = self->nHead + nStartOffset;
+        status = Lock(self);
 
-        if (nHead + nCount > self->init.nBufferSize)
+        if (status != LIBCB_SUCCESS)
         {
-            uint32_t nFirstCopySize = self->init.nBufferSize - nHead;
-            uint32_t nSecondCopySize = nCount - nFirstCopySize;
-
-            memcpy(pDestination, (uint8_t *)self->init.pBuffer + nHead, nFirstCopySize);
-            memcpy((uint8_t *)pDestination + nFirstCopySize, self->init.pBuffer, nSecondCopySize);
+            break;
         }
-        else
+
+        // a pop may have shrunk the content since it was checked above
+        if (nStartOffset + nCount > GetUsed(self))
         {
-            memcpy(pDestination, (uint8_t *)self->init.pBuffer + nHead, nCount);
+            status = LIBCB_BUFFERUNDERFLOW;
+            Release(self);
+            break;
         }
 
-        Release(self);
+        uint32_t nOffset = IndexToOffset(self, IndexAdvance(self, self->nHead, nStartOffset));
+
+        CopyFromBuffer(self, self->pfnCopyOut, nOffset, pDestination, nCount);
+
+        status = Release(self);
 
         break;
     }
 
     return status;
-}
\ No newline at end of file
+}
+
+int32_t circularBufferFind(CircularBuffer *self, uint8_t nByte, uint32_t nStartOffset)
+{
+    return circularBufferFindPattern(self, &nByte, 1, nStartOffset);
+}
+
+int32_t circularBufferFindPattern(CircularBuffer *self, const void *pPattern, uint32_t nPatternSize, uint32_t nStartOffset)
+{
+    int32_t status = LIBCB_SUCCESS;
+    CircularBufferSpan aSpans[2];
+
+    for (;;)
+    {
+        if (self == NULL || pPattern == NULL || nPatternSize == 0)
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        if (self->init.nFlags & LIBCB_FLAG_SPSC)
+        {
+            // only the consumer moves the head, the producer only appends behind the tail
+            uint32_t nHead = __atomic_load_n(&self->nHead, __ATOMIC_RELAXED);
+            uint32_t nUsed = IndexDistance(self, nHead, LoadTail(self));
+
+            if (nUsed == 0)
+            {
+                status = LIBCB_BUFFEREMPTY;
+                break;
+            }
+
+            if (nStartOffset > nUsed)
+            {
+                status = LIBCB_BUFFERUNDERFLOW;
+                break;
+            }
+
+            GetSpans(self, IndexToOffset(self, IndexAdvance(self, nHead, nStartOffset)), nUsed - nStartOffset, aSpans);
+            status = SearchSpans(aSpans, (const uint8_t *)pPattern, nPatternSize);
+            break;
+        }
+
+        status = Lock(self);
+
+        if (status != LIBCB_SUCCESS)
+        {
+            break;
+        }
+
+        uint32_t nUsed = GetUsed(self);
+
+        if (nUsed == 0)
+        {
+            status = LIBCB_BUFFEREMPTY;
+            Release(self);
+            break;
+        }
+
+        if (nStartOffset > nUsed)
+        {
+            status = LIBCB_BUFFERUNDERFLOW;
+            Release(self);
+            break;
+        }
+
+        GetSpans(self, IndexToOffset(self, IndexAdvance(self, self->nHead, nStartOffset)), nUsed - nStartOffset, aSpans);
+
+        int32_t nFound = SearchSpans(aSpans, (const uint8_t *)pPattern, nPatternSize);
+
+        status = Release(self);
+
+        if (status == LIBCB_SUCCESS)
+        {
+            status = nFound;
+        }
+
+        break;
+    }
+
+    if (status >= 0)
+    {
+        status += (int32_t)nStartOffset;
+    }
+
+    return status;
+}
+
+int32_t circularBufferCrc(CircularBuffer *self, uint32_t nStartOffset, uint32_t nCount, uint32_t *pnCrc)
+{
+    int32_t status = LIBCB_SUCCESS;
+    CircularBufferSpan aSpans[2];
+
+    for (;;)
+    {
+        if (self == NULL || pnCrc == NULL)
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        if (self->init.nFlags & LIBCB_FLAG_SPSC)
+        {
+            uint32_t nHead = __atomic_load_n(&self->nHead, __ATOMIC_RELAXED);
+
+            if (nStartOffset + nCount > IndexDistance(self, nHead, LoadTail(self)))
+            {
+                status = LIBCB_BUFFERUNDERFLOW;
+                break;
+            }
+
+            GetSpans(self, IndexToOffset(self, IndexAdvance(self, nHead, nStartOffset)), nCount, aSpans);
+            *pnCrc = circularBufferCrc32c(circularBufferCrc32c(0, aSpans[0].pData, aSpans[0].nSize), aSpans[1].pData, aSpans[1].nSize);
+            break;
+        }
+
+        status = Lock(self);
+
+        if (status != LIBCB_SUCCESS)
+        {
+            break;
+        }
+
+        if (nStartOffset + nCount > GetUsed(self))
+        {
+            status = LIBCB_BUFFERUNDERFLOW;
+            Release(self);
+            break;
+        }
+
+        GetSpans(self, IndexToOffset(self, IndexAdvance(self, self->nHead, nStartOffset)), nCount, aSpans);
+        *pnCrc = circularBufferCrc32c(circularBufferCrc32c(0, aSpans[0].pData, aSpans[0].nSize), aSpans[1].pData, aSpans[1].nSize);
+
+        status = Release(self);
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t circularBufferGetPushedCrc(CircularBuffer *self, uint32_t *pnCrc, uint8_t bReset)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (self == NULL || pnCrc == NULL || !(self->init.nFlags & LIBCB_FLAG_CRC))
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        // the lock-free producer owns the CRC, the caller has to be that producer
+        if (self->init.nFlags & LIBCB_FLAG_SPSC)
+        {
+            *pnCrc = self->nPushedCrc;
+
+            if (bReset)
+            {
+                self->nPushedCrc = 0;
+            }
+
+            break;
+        }
+
+        status = Lock(self);
+
+        if (status != LIBCB_SUCCESS)
+        {
+            break;
+        }
+
+        *pnCrc = self->nPushedCrc;
+
+        if (bReset)
+        {
+            self->nPushedCrc = 0;
+        }
+
+        status = Release(self);
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t circularBufferReserve(CircularBuffer *self, uint32_t nSize, CircularBufferSpan aSpans[2])
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        // raw bytes committed into a record buffer would break its framing
+        if (self == NULL || aSpans == NULL || nSize == 0 || (self->init.nFlags & LIBCB_FLAG_RECORD))
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        if (self->init.nFlags & LIBCB_FLAG_SPSC)
+        {
+            uint32_t nTail = __atomic_load_n(&self->nTail, __ATOMIC_RELAXED);
+            uint32_t nHead = LoadHead(self);
+
+            if (self->init.nBufferSize - IndexDistance(self, nHead, nTail) < nSize)
+            {
+                status = LIBCB_BUFFEROVERFLOW;
+                break;
+            }
+
+            GetSpans(self, IndexToOffset(self, nTail), nSize, aSpans);
+            self->nReserved = nSize;
+            break;
+        }
+
+        status = Lock(self);
+
+        if (status != LIBCB_SUCCESS)
+        {
+            break;
+        }
+
+        if (self->pResizePolicy != NULL && self->init.nBufferSize - GetUsed(self) < nSize)
+        {
+            Grow(self, nSize);
+        }
+
+        if ((self->init.nFlags & LIBCB_FLAG_OVERWRITE) && nSize <= self->init.nBufferSize)
+        {
+            DropOldest(self, nSize);
+        }
+
+        if (self->init.nBufferSize - GetUsed(self) < nSize)
+        {
+            Release(self);
+            status = LIBCB_BUFFEROVERFLOW;
+            break;
+        }
+
+        // the mutex stays held until the reservation is committed
+        GetSpans(self, IndexToOffset(self, self->nTail), nSize, aSpans);
+        self->nReserved = nSize;
+
+        break;
+    }
+
+    if (status == LIBCB_BUFFEROVERFLOW)
+    {
+        CountOverflow(self);
+        ArmWritable(self, nSize);
+    }
+
+    return status;
+}
+
+int32_t circularBufferCommit(CircularBuffer *self, uint32_t nSize)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        // only valid after a successful reserve, which always hands out bytes
+        if (self == NULL || self->nReserved == 0 || nSize > self->nReserved)
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        if (self->init.nFlags & LIBCB_FLAG_SPSC)
+        {
+            uint32_t nTail = __atomic_load_n(&self->nTail, __ATOMIC_RELAXED);
+
+            self->nReserved = 0;
+
+            if (nSize != 0)
+            {
+                FoldPushedCrc(self, IndexToOffset(self, nTail), nSize);
+                __atomic_store_n(&self->nTail, IndexAdvance(self, nTail, nSize), __ATOMIC_RELEASE);
+                CountPushed(self, nSize);
+            }
+
+            break;
+        }
+
+        if (nSize != 0)
+        {
+            // the caller wrote the bytes in place, they are read back for the CRC
+            FoldPushedCrc(self, IndexToOffset(self, self->nTail), nSize);
+            MoveTail(self, nSize);
+            CountPushed(self, nSize);
+        }
+
+        self->nReserved = 0;
+
+        status = Release(self);
+
+        break;
+    }
+
+    // committing nothing only ends the reservation, there is nothing to signal
+    if (status == LIBCB_SUCCESS && nSize != 0)
+    {
+        NotifyPushed(self);
+    }
+
+    return status;
+}
+
+int32_t circularBufferPeek(CircularBuffer *self, CircularBufferSpan aSpans[2])
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (self == NULL || aSpans == NULL || (self->init.nFlags & LIBCB_FLAG_RECORD))
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        if (self->init.nFlags & LIBCB_FLAG_SPSC)
+        {
+            uint32_t nHead = __atomic_load_n(&self->nHead, __ATOMIC_RELAXED);
+            uint32_t nTail = LoadTail(self);
+            uint32_t nUsed = IndexDistance(self, nHead, nTail);
+
+            if (nUsed == 0)
+            {
+                status = LIBCB_BUFFEREMPTY;
+                break;
+            }
+
+            GetSpans(self, IndexToOffset(self, nHead), nUsed, aSpans);
+            self->nPeeked = nUsed;
+            break;
+        }
+
+        status = Lock(self);
+
+        if (status != LIBCB_SUCCESS)
+        {
+            break;
+        }
+
+        if (GetUsed(self) == 0)
+        {
+            Release(self);
+            status = LIBCB_BUFFEREMPTY;
+            break;
+        }
+
+        // the mutex stays held until the peeked data is consumed
+        self->nPeeked = GetUsed(self);
+        GetSpans(self, IndexToOffset(self, self->nHead), self->nPeeked, aSpans);
+
+        break;
+    }
+
+    if (status == LIBCB_BUFFEREMPTY)
+    {
+        CountUnderflow(self);
+        ArmReadable(self, 1);
+    }
+
+    return status;
+}
+
+int32_t circularBufferConsume(CircularBuffer *self, uint32_t nSize)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        // only valid after a successful peek, which always hands out bytes
+        if (self == NULL || self->nPeeked == 0 || nSize > self->nPeeked)
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        if (self->init.nFlags & LIBCB_FLAG_SPSC)
+        {
+            uint32_t nHead = __atomic_load_n(&self->nHead, __ATOMIC_RELAXED);
+
+            self->nPeeked = 0;
+            __atomic_store_n(&self->nHead, IndexAdvance(self, nHead, nSize), __ATOMIC_RELEASE);
+            CountPopped(self, nSize);
+            break;
+        }
+
+        MoveHead(self, nSize);
+        CountPopped(self, nSize);
+        self->nPeeked = 0;
+
+        // the peeked spans are given up here, the storage may move now
+        if (nSize != 0)
+        {
+            Shrink(self, GetUsed(self) + nSize);
+        }
+
+        status = Release(self);
+
+        break;
+    }
+
+    if (status == LIBCB_SUCCESS)
+    {
+        NotifyPopped(self);
+    }
+
+    return status;
+}
+
+int32_t circularBufferPushRecord(CircularBuffer *self, const void *pSource, uint32_t nSourceSize)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (self == NULL || pSource == NULL || !(self->init.nFlags & LIBCB_FLAG_RECORD))
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        uint32_t nWritten = 0;
+
+        if (self->init.nFlags & LIBCB_FLAG_SPSC)
+        {
+            uint32_t nTail = __atomic_load_n(&self->nTail, __ATOMIC_RELAXED);
+            uint32_t nHead = LoadHead(self);
+            uint32_t nFree = self->init.nBufferSize - IndexDistance(self, nHead, nTail);
+
+            status = WriteRecord(self, nTail, nFree, pSource, nSourceSize, &nWritten);
+
+            if (status == LIBCB_SUCCESS)
+            {
+                __atomic_store_n(&self->nTail, IndexAdvance(self, nTail, nWritten), __ATOMIC_RELEASE);
+                CountPushed(self, nWritten);
+            }
+
+            break;
+        }
+
+        status = Lock(self);
+
+        if (status != LIBCB_SUCCESS)
+        {
+            break;
+        }
+
+        uint32_t nTrailer = (self->init.nFlags & LIBCB_FLAG_RECORDCRC) ? LIBCB_RECORD_CRC_SIZE : 0;
+
+        for (;;)
+        {
+            // an empty buffer starts over at offset 0 so no padding is needed
+            if (GetUsed(self) == 0 && (self->init.nFlags & LIBCB_FLAG_RECORDNOWRAP))
+            {
+                self->nHead = 0;
+                self->nTail = 0;
+            }
+
+            status = WriteRecord(self, self->nTail, self->init.nBufferSize - GetUsed(self), pSource, nSourceSize, &nWritten);
+
+            if (status != LIBCB_BUFFEROVERFLOW)
+            {
+                break;
+            }
+
+            // every growth unwraps the data, so the record follows it without padding
+            if (
+                self->pResizePolicy != NULL &&
+                Grow(self, LIBCB_RECORD_HEADER_SIZE + nTrailer + nSourceSize) == LIBCB_SUCCESS
+                )
+            {
+                continue;
+            }
+
+            // a record larger than the whole buffer would empty it for nothing
+            if (
+                !(self->init.nFlags & LIBCB_FLAG_OVERWRITE) || GetUsed(self) == 0 ||
+                nSourceSize > self->init.nBufferSize - LIBCB_RECORD_HEADER_SIZE - nTrailer
+                )
+            {
+                break;
+            }
+
+            DropOldest(self, self->init.nBufferSize - GetUsed(self) + 1);
+        }
+
+        if (status == LIBCB_SUCCESS)
+        {
+            MoveTail(self, nWritten);
+            CountPushed(self, nWritten);
+        }
+
+        if (Release(self) != LIBCB_SUCCESS)
+        {
+            status = LIBCB_MUTEXERROR;
+        }
+
+        break;
+    }
+
+    if (status == LIBCB_SUCCESS)
+    {
+        NotifyPushed(self);
+    }
+    else if (status == LIBCB_BUFFEROVERFLOW)
+    {
+        CountOverflow(self);
+        ArmWritable(self, LIBCB_RECORD_HEADER_SIZE + nSourceSize);
+    }
+
+    return status;
+}
+
+int32_t circularBufferPopRecord(CircularBuffer *self, void *pDestination, uint32_t nDestinationSize, uint32_t *pnSize)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (self == NULL || (pDestination == NULL && nDestinationSize != 0) || !(self->init.nFlags & LIBCB_FLAG_RECORD))
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        uint32_t nHead, nUsed, nSkip, nSize;
+        uint8_t bLockFree = (self->init.nFlags & LIBCB_FLAG_SPSC) != 0;
+
+        if (bLockFree)
+        {
+            nHead = __atomic_load_n(&self->nHead, __ATOMIC_RELAXED);
+            nUsed = IndexDistance(self, nHead, LoadTail(self));
+        }
+        else
+        {
+            status = Lock(self);
+
+            if (status != LIBCB_SUCCESS)
+            {
+                break;
+            }
+
+            nHead = self->nHead;
+            nUsed = GetUsed(self);
+        }
+
+        status = ParseRecord(self, nHead, nUsed, &nSkip, &nSize);
+
+        // the stored size includes the CRC behind the payload
+        uint32_t nTrailer = (self->init.nFlags & LIBCB_FLAG_RECORDCRC) ? LIBCB_RECORD_CRC_SIZE : 0;
+
+        if (status == LIBCB_SUCCESS && nSize - nTrailer > nDestinationSize)
+        {
+            status = LIBCB_BUFFEROVERFLOW;
+        }
+
+        if (status == LIBCB_SUCCESS)
+        {
+            uint32_t nPayload = IndexAdvance(self, nHead, nSkip + LIBCB_RECORD_HEADER_SIZE);
+
+            if (nTrailer != 0)
+            {
+                uint32_t nStored = 0;
+                uint32_t nCrc = CopyFromBufferCrc(self, IndexToOffset(self, nPayload), pDestination, nSize - nTrailer, 0);
+
+                CopyFromBuffer(self, self->pfnCopyOut, IndexToOffset(self, IndexAdvance(self, nPayload, nSize - nTrailer)), &nStored, sizeof(nStored));
+
+                if (nCrc != nStored)
+                {
+                    status = LIBCB_CHECKSUMERROR;
+                }
+            }
+            else
+            {
+                CopyFromBuffer(self, self->pfnCopyOut, IndexToOffset(self, nPayload), pDestination, nSize);
+            }
+
+            if (pnSize != NULL)
+            {
+                *pnSize = nSize - nTrailer;
+            }
+
+            nHead = IndexAdvance(self, nPayload, nSize);
+
+            if (bLockFree)
+            {
+                __atomic_store_n(&self->nHead, nHead, __ATOMIC_RELEASE);
+            }
+            else
+            {
+                MoveHead(self, nSkip + LIBCB_RECORD_HEADER_SIZE + nSize);
+            }
+
+            CountPopped(self, nSkip + LIBCB_RECORD_HEADER_SIZE + nSize);
+
+            if (!bLockFree)
+            {
+                Shrink(self, nUsed);
+            }
+        }
+
+        if (!bLockFree && Release(self) != LIBCB_SUCCESS)
+        {
+            status = LIBCB_MUTEXERROR;
+        }
+
+        break;
+    }
+
+    // a record that failed its check is removed all the same
+    if (status == LIBCB_SUCCESS || status == LIBCB_CHECKSUMERROR)
+    {
+        NotifyPopped(self);
+    }
+    else if (status == LIBCB_BUFFEREMPTY)
+    {
+        CountUnderflow(self);
+        ArmReadable(self, 1);
+    }
+
+    return status;
+}
+
+int32_t circularBufferGetNextRecordSize(CircularBuffer *self)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (self == NULL || !(self->init.nFlags & LIBCB_FLAG_RECORD))
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        uint32_t nSkip, nSize;
+
+        if (self->init.nFlags & LIBCB_FLAG_SPSC)
+        {
+            uint32_t nHead = __atomic_load_n(&self->nHead, __ATOMIC_RELAXED);
+            uint32_t nTail = LoadTail(self);
+
+            status = ParseRecord(self, nHead, IndexDistance(self, nHead, nTail), &nSkip, &nSize);
+        }
+        else
+        {
+            status = Lock(self);
+
+            if (status == LIBCB_SUCCESS)
+            {
+                status = ParseRecord(self, self->nHead, GetUsed(self), &nSkip, &nSize);
+
+                if (Release(self) != LIBCB_SUCCESS)
+                {
+                    status = LIBCB_MUTEXERROR;
+                }
+            }
+        }
+
+        if (status == LIBCB_SUCCESS)
+        {
+            status = (int32_t)nSize;
+
+            if (self->init.nFlags & LIBCB_FLAG_RECORDCRC)
+            {
+                status -= LIBCB_RECORD_CRC_SIZE;
+            }
+        }
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t circularBufferPushv(CircularBuffer *self, const CircularBufferSpan *aSources, uint32_t nSourceCount, uint32_t nMode)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (
+            self == NULL || aSources == NULL || nSourceCount == 0 ||
+            (nMode != LIBCB_BATCH_ALLORNOTHING && nMode != LIBCB_BATCH_PARTIAL)
+            )
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        uint32_t nTail, nFree, nWritten = 0, i;
+        uint8_t bLockFree = (self->init.nFlags & LIBCB_FLAG_SPSC) != 0;
+
+        if (bLockFree)
+        {
+            nTail = __atomic_load_n(&self->nTail, __ATOMIC_RELAXED);
+            nFree = self->init.nBufferSize - IndexDistance(self, LoadHead(self), nTail);
+        }
+        else
+        {
+            status = Lock(self);
+
+            if (status != LIBCB_SUCCESS)
+            {
+                break;
+            }
+
+            nTail = self->nTail;
+            nFree = self->init.nBufferSize - GetUsed(self);
+        }
+
+        // everything is written ahead of the tail and published in one step
+        for (i = 0; i < nSourceCount; i++)
+        {
+            uint32_t nSize = aSources[i].nSize;
+
+            if (aSources[i].pData == NULL && nSize != 0)
+            {
+                status = LIBCB_INVALIDPARAM;
+                break;
+            }
+
+            if (self->init.nFlags & LIBCB_FLAG_RECORD)
+            {
+                if (WriteRecord(self, IndexAdvance(self, nTail, nWritten), nFree - nWritten, aSources[i].pData, nSize, &nSize) != LIBCB_SUCCESS)
+                {
+                    break;
+                }
+            }
+            else
+            {
+                if (nFree - nWritten < nSize)
+                {
+                    break;
+                }
+
+                CopyToBuffer(self, self->pfnCopy, IndexToOffset(self, IndexAdvance(self, nTail, nWritten)), aSources[i].pData, nSize);
+            }
+
+            nWritten += nSize;
+        }
+
+        if (status == LIBCB_SUCCESS && nMode == LIBCB_BATCH_ALLORNOTHING && i < nSourceCount)
+        {
+            status = LIBCB_BUFFEROVERFLOW;
+        }
+
+        if (status == LIBCB_SUCCESS)
+        {
+            // only the published bytes count, an all-or-nothing failure wrote others
+            if (!(self->init.nFlags & LIBCB_FLAG_RECORD) && nWritten != 0)
+            {
+                FoldPushedCrc(self, IndexToOffset(self, nTail), nWritten);
+            }
+
+            if (bLockFree)
+            {
+                __atomic_store_n(&self->nTail, IndexAdvance(self, nTail, nWritten), __ATOMIC_RELEASE);
+            }
+            else
+            {
+                MoveTail(self, nWritten);
+            }
+
+            CountPushed(self, nWritten);
+
+            status = (int32_t)i;
+        }
+
+        if (!bLockFree && Release(self) != LIBCB_SUCCESS)
+        {
+            status = LIBCB_MUTEXERROR;
+        }
+
+        break;
+    }
+
+    if (status > 0)
+    {
+        NotifyPushed(self);
+    }
+    else if (status == 0 || status == LIBCB_BUFFEROVERFLOW)
+    {
+        CountOverflow(self);
+        ArmWritable(self, 1);
+    }
+
+    return status;
+}
+
+int32_t circularBufferPopv(CircularBuffer *self, CircularBufferSpan *aDestinations, uint32_t nDestinationCount, uint32_t nMode)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (
+            self == NULL || aDestinations == NULL || nDestinationCount == 0 ||
+            (nMode != LIBCB_BATCH_ALLORNOTHING && nMode != LIBCB_BATCH_PARTIAL)
+            )
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        // a batch is not checked record by record
+        if (self->init.nFlags & LIBCB_FLAG_RECORDCRC)
+        {
+            status = LIBCB_NOTSUPPORTED;
+            break;
+        }
+
+        uint32_t nHead, nUsed, nRead = 0, i;
+        uint8_t bLockFree = (self->init.nFlags & LIBCB_FLAG_SPSC) != 0;
+
+        if (bLockFree)
+        {
+            nHead = __atomic_load_n(&self->nHead, __ATOMIC_RELAXED);
+            nUsed = IndexDistance(self, nHead, LoadTail(self));
+        }
+        else
+        {
+            status = Lock(self);
+
+            if (status != LIBCB_SUCCESS)
+            {
+                break;
+            }
+
+            nHead = self->nHead;
+            nUsed = GetUsed(self);
+        }
+
+        // an all-or-nothing batch of records is checked before any nSize is touched
+        uint8_t bCopy = nMode == LIBCB_BATCH_PARTIAL || !(self->init.nFlags & LIBCB_FLAG_RECORD);
+
+        for (;;)
+        {
+            for (i = 0; i < nDestinationCount; i++)
+            {
+                uint32_t nIndex = IndexAdvance(self, nHead, nRead);
+                uint32_t nSize = aDestinations[i].nSize;
+                uint32_t nSkip = 0;
+
+                if (aDestinations[i].pData == NULL && nSize != 0)
+                {
+                    status = LIBCB_INVALIDPARAM;
+                    break;
+                }
+
+                if (self->init.nFlags & LIBCB_FLAG_RECORD)
+                {
+                    if (
+                        ParseRecord(self, nIndex, nUsed - nRead, &nSkip, &nSize) != LIBCB_SUCCESS ||
+                        nSize > aDestinations[i].nSize
+                        )
+                    {
+                        break;
+                    }
+
+                    nSkip += LIBCB_RECORD_HEADER_SIZE;
+                }
+                else if (nUsed - nRead < nSize)
+                {
+                    break;
+                }
+
+                if (bCopy)
+                {
+                    CopyFromBuffer(self, self->pfnCopyOut, IndexToOffset(self, IndexAdvance(self, nIndex, nSkip)), aDestinations[i].pData, nSize);
+                    aDestinations[i].nSize = nSize;
+                }
+
+                nRead += nSkip + nSize;
+            }
+
+            if (status == LIBCB_SUCCESS && nMode == LIBCB_BATCH_ALLORNOTHING && i < nDestinationCount)
+            {
+                status = LIBCB_BUFFERUNDERFLOW;
+            }
+
+            if (status != LIBCB_SUCCESS || bCopy)
+            {
+                break;
+            }
+
+            bCopy = TRUE;
+            nRead = 0;
+        }
+
+        if (status == LIBCB_SUCCESS)
+        {
+            if (bLockFree)
+            {
+                __atomic_store_n(&self->nHead, IndexAdvance(self, nHead, nRead), __ATOMIC_RELEASE);
+            }
+            else
+            {
+                MoveHead(self, nRead);
+
+                if (nRead != 0)
+                {
+                    Shrink(self, nUsed);
+                }
+            }
+
+            CountPopped(self, nRead);
+
+            status = (int32_t)i;
+        }
+
+        if (!bLockFree && Release(self) != LIBCB_SUCCESS)
+        {
+            status = LIBCB_MUTEXERROR;
+        }
+
+        break;
+    }
+
+    if (status > 0)
+    {
+        NotifyPopped(self);
+    }
+    else if (status == 0 || status == LIBCB_BUFFERUNDERFLOW)
+    {
+        CountUnderflow(self);
+        ArmReadable(self, 1);
+    }
+
+    return status;
+}
+
+int32_t circularBufferPushPartial(CircularBuffer *self, const void *pSource, uint32_t nSourceSize)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (
+            self == NULL || pSource == NULL || nSourceSize == 0 ||
+            (self->init.nFlags & LIBCB_FLAG_RECORD)
+            )
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        uint32_t nSize;
+
+        if (self->init.nFlags & LIBCB_FLAG_SPSC)
+        {
+            uint32_t nTail = __atomic_load_n(&self->nTail, __ATOMIC_RELAXED);
+            uint32_t nHead = LoadHead(self);
+
+            nSize = self->init.nBufferSize - IndexDistance(self, nHead, nTail);
+            nSize = nSize < nSourceSize ? nSize : nSourceSize;
+
+            if (self->init.nFlags & LIBCB_FLAG_CRC)
+            {
+                self->nPushedCrc = CopyToBufferCrc(self, IndexToOffset(self, nTail), pSource, nSize, self->nPushedCrc);
+            }
+            else
+            {
+                CopyToBuffer(self, self->pfnCopy, IndexToOffset(self, nTail), pSource, nSize);
+            }
+
+            __atomic_store_n(&self->nTail, IndexAdvance(self, nTail, nSize), __ATOMIC_RELEASE);
+            CountPushed(self, nSize);
+
+            status = (int32_t)nSize;
+            break;
+        }
+
+        status = Lock(self);
+
+        if (status != LIBCB_SUCCESS)
+        {
+            break;
+        }
+
+        if (self->init.nFlags & LIBCB_FLAG_OVERWRITE)
+        {
+            DropOldest(self, nSourceSize < self->init.nBufferSize ? nSourceSize : self->init.nBufferSize);
+        }
+
+        nSize = self->init.nBufferSize - GetUsed(self);
+        nSize = nSize < nSourceSize ? nSize : nSourceSize;
+
+        if (self->init.nFlags & LIBCB_FLAG_CRC)
+        {
+            self->nPushedCrc = CopyToBufferCrc(self, IndexToOffset(self, self->nTail), pSource, nSize, self->nPushedCrc);
+        }
+        else
+        {
+            CopyToBuffer(self, self->pfnCopy, IndexToOffset(self, self->nTail), pSource, nSize);
+        }
+
+        MoveTail(self, nSize);
+        CountPushed(self, nSize);
+
+        status = Release(self);
+
+        if (status == LIBCB_SUCCESS)
+        {
+            status = (int32_t)nSize;
+        }
+
+        break;
+    }
+
+    if (status > 0)
+    {
+        NotifyPushed(self);
+    }
+    else if (status == 0)
+    {
+        CountOverflow(self);
+        ArmWritable(self, 1);
+    }
+
+    return status;
+}
+
+int32_t circularBufferPopPartial(CircularBuffer *self, void *pDestination, uint32_t nDestinationSize)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (
+            self == NULL || pDestination == NULL || nDestinationSize == 0 ||
+            (self->init.nFlags & LIBCB_FLAG_RECORD)
+            )
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        uint32_t nSize;
+
+        if (self->init.nFlags & LIBCB_FLAG_SPSC)
+        {
+            uint32_t nHead = __atomic_load_n(&self->nHead, __ATOMIC_RELAXED);
+            uint32_t nTail = LoadTail(self);
+
+            nSize = IndexDistance(self, nHead, nTail);
+            nSize = nSize < nDestinationSize ? nSize : nDestinationSize;
+
+            CopyFromBuffer(self, self->pfnCopyOut, IndexToOffset(self, nHead), pDestination, nSize);
+            __atomic_store_n(&self->nHead, IndexAdvance(self, nHead, nSize), __ATOMIC_RELEASE);
+            CountPopped(self, nSize);
+
+            status = (int32_t)nSize;
+            break;
+        }
+
+        status = Lock(self);
+
+        if (status != LIBCB_SUCCESS)
+        {
+            break;
+        }
+
+        nSize = GetUsed(self) < nDestinationSize ? GetUsed(self) : nDestinationSize;
+
+        CopyFromBuffer(self, self->pfnCopyOut, IndexToOffset(self, self->nHead), pDestination, nSize);
+        MoveHead(self, nSize);
+        CountPopped(self, nSize);
+
+        if (nSize != 0)
+        {
+            Shrink(self, GetUsed(self) + nSize);
+        }
+
+        status = Release(self);
+
+        if (status == LIBCB_SUCCESS)
+        {
+            status = (int32_t)nSize;
+        }
+
+        break;
+    }
+
+    if (status > 0)
+    {
+        NotifyPopped(self);
+    }
+    else if (status == 0)
+    {
+        CountUnderflow(self);
+        ArmReadable(self, 1);
+    }
+
+    return status;
+}
+
+int32_t circularBufferPushWait(CircularBuffer *self, void *pSource, uint32_t nSourceSize, uint32_t nTimeoutMs)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (self == NULL || !(self->init.nFlags & LIBCB_FLAG_BLOCKING))
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        uint64_t nDeadline = circularBufferWaitDeadline(nTimeoutMs);
+
+        // the first attempt does not announce a waiter, so it never causes a wakeup
+        status = circularBufferPush(self, pSource, nSourceSize);
+
+        while (status == LIBCB_BUFFEROVERFLOW && nSourceSize <= self->init.nBufferSize)
+        {
+            uint32_t nSequence = BeginWait(&self->nPushSequence, &self->nPushWaiters);
+
+            status = circularBufferPush(self, pSource, nSourceSize);
+
+            if (status == LIBCB_BUFFEROVERFLOW)
+            {
+                int32_t waitStatus = circularBufferFutexWait(&self->nPushSequence, nSequence, nDeadline);
+
+                status = waitStatus == LIBCB_SUCCESS ? status : waitStatus;
+            }
+
+            __atomic_sub_fetch(&self->nPushWaiters, 1, __ATOMIC_RELAXED);
+        }
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t circularBufferPopWait(CircularBuffer *self, void *pDestination, uint32_t nDestinationSize, uint32_t nTimeoutMs)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (self == NULL || !(self->init.nFlags & LIBCB_FLAG_BLOCKING))
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        uint64_t nDeadline = circularBufferWaitDeadline(nTimeoutMs);
+
+        status = circularBufferPop(self, pDestination, nDestinationSize);
+
+        while (
+            (status == LIBCB_BUFFEREMPTY || status == LIBCB_BUFFERUNDERFLOW) &&
+            nDestinationSize <= self->init.nBufferSize
+            )
+        {
+            uint32_t nSequence = BeginWait(&self->nPopSequence, &self->nPopWaiters);
+
+            status = circularBufferPop(self, pDestination, nDestinationSize);
+
+            if (status == LIBCB_BUFFEREMPTY || status == LIBCB_BUFFERUNDERFLOW)
+            {
+                int32_t waitStatus = circularBufferFutexWait(&self->nPopSequence, nSequence, nDeadline);
+
+                status = waitStatus == LIBCB_SUCCESS ? status : waitStatus;
+            }
+
+            __atomic_sub_fetch(&self->nPopWaiters, 1, __ATOMIC_RELAXED);
+        }
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t circularBufferGetReadableFd(CircularBuffer *self)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (self == NULL || !(self->init.nFlags & LIBCB_FLAG_EVENTFD))
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        status = self->nReadableFd;
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t circularBufferGetWritableFd(CircularBuffer *self)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (self == NULL || !(self->init.nFlags & LIBCB_FLAG_EVENTFD))
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        status = self->nWritableFd;
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t circularBufferResize(CircularBuffer *self, void *pBuffer, uint32_t nBufferSize, void **ppOldBuffer)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (self == NULL || pBuffer == NULL || nBufferSize == 0)
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        // the mapping and the lock-free indexes are tied to the size they started with
+        if (self->init.nFlags & (LIBCB_FLAG_SPSC | LIBCB_FLAG_MIRRORED))
+        {
+            status = LIBCB_NOTSUPPORTED;
+            break;
+        }
+
+        if (
+            ((self->init.nFlags & LIBCB_FLAG_POWEROFTWO) && (nBufferSize & (nBufferSize - 1)) != 0) ||
+            ((self->init.nFlags & LIBCB_FLAG_RECORD) && nBufferSize <= LIBCB_RECORD_HEADER_SIZE + LIBCB_RECORD_CRC_SIZE)
+            )
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        status = Lock(self);
+
+        if (status != LIBCB_SUCCESS)
+        {
+            break;
+        }
+
+        void *pOldBuffer = self->init.pBuffer;
+
+        status = MoveStorage(self, pBuffer, nBufferSize);
+
+        if (status == LIBCB_SUCCESS && ppOldBuffer != NULL)
+        {
+            *ppOldBuffer = pOldBuffer;
+        }
+
+        if (Release(self) != LIBCB_SUCCESS)
+        {
+            status = LIBCB_MUTEXERROR;
+        }
+
+        break;
+    }
+
+    // a larger storage may take what a waiting producer holds
+    if (status == LIBCB_SUCCESS)
+    {
+        NotifyPopped(self);
+    }
+
+    return status;
+}
+
+int32_t circularBufferSetResizePolicy(CircularBuffer *self, const CircularBufferResizePolicy *pPolicy)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (self == NULL)
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        if (self->init.nFlags & (LIBCB_FLAG_SPSC | LIBCB_FLAG_MIRRORED))
+        {
+            status = LIBCB_NOTSUPPORTED;
+            break;
+        }
+
+        if (
+            pPolicy != NULL &&
+            (
+                pPolicy->pfnAllocate == NULL || pPolicy->pfnFree == NULL || pPolicy->nMaxSize < pPolicy->nMinSize ||
+                (pPolicy->nMinSize != 0 && pPolicy->nShrinkAfter == 0) ||
+                ((self->init.nFlags & LIBCB_FLAG_RECORD) && pPolicy->nMinSize != 0 && pPolicy->nMinSize <= LIBCB_RECORD_HEADER_SIZE + LIBCB_RECORD_CRC_SIZE) ||
+                // doubling and halving stay on powers of two between the bounds
+                ((self->init.nFlags & LIBCB_FLAG_POWEROFTWO) &&
+                    ((pPolicy->nMaxSize & (pPolicy->nMaxSize - 1)) != 0 || (pPolicy->nMinSize & (pPolicy->nMinSize - 1)) != 0))
+            )
+            )
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        status = Lock(self);
+
+        if (status != LIBCB_SUCCESS)
+        {
+            break;
+        }
+
+        self->pResizePolicy = pPolicy;
+        self->nResizePeak = GetUsed(self);
+        self->nResizePops = 0;
+
+        status = Release(self);
+
+        break;
+    }
+
+    return status;
+}
+
+uint32_t IndexToOffset(const CircularBuffer *self, uint32_t nIndex)
+{
+    if (self->init.nFlags & LIBCB_FLAG_POWEROFTWO)
+    {
+        return nIndex & (self->init.nBufferSize - 1);
+    }
+
+    return nIndex < self->init.nBufferSize ? nIndex : nIndex - self->init.nBufferSize;
+}
+
+uint32_t IndexAdvance(const CircularBuffer *self, uint32_t nIndex, uint32_t nSize)
+{
+    // free-running indexes wrap at 2^32, which is a multiple of the size
+    if (self->init.nFlags & LIBCB_FLAG_POWEROFTWO)
+    {
+        return nIndex + nSize;
+    }
+
+    if (self->init.nFlags & LIBCB_FLAG_SPSC)
+    {
+        uint32_t nLimit = self->init.nBufferSize * 2;
+
+        nIndex += nSize;
+
+        return nIndex < nLimit ? nIndex : nIndex - nLimit;
+    }
+
+    // locked indexes may rest on nBufferSize, nCount tells full from empty
+    nIndex += nSize;
+
+    return nIndex > self->init.nBufferSize ? nIndex - self->init.nBufferSize : nIndex;
+}
+
+uint32_t IndexDistance(const CircularBuffer *self, uint32_t nHead, uint32_t nTail)
+{
+    uint32_t nDistance;
+
+    if (self->init.nFlags & LIBCB_FLAG_POWEROFTWO)
+    {
+        nDistance = nTail - nHead;
+    }
+    else
+    {
+        nDistance = nTail >= nHead ? nTail - nHead : nTail + self->init.nBufferSize * 2 - nHead;
+    }
+
+    // the indexes are sampled one after the other, never report past capacity
+    return nDistance <= self->init.nBufferSize ? nDistance : self->init.nBufferSize;
+}
+
+uint32_t GetUsed(CircularBuffer *self)
+{
+    if (self->init.nFlags & LIBCB_FLAG_SPSC)
+    {
+        uint32_t nHead = __atomic_load_n(&self->nHead, __ATOMIC_ACQUIRE);
+        uint32_t nTail = __atomic_load_n(&self->nTail, __ATOMIC_ACQUIRE);
+
+        return IndexDistance(self, nHead, nTail);
+    }
+
+    if (self->init.nFlags & LIBCB_FLAG_POWEROFTWO)
+    {
+        return self->nTail - self->nHead;
+    }
+
+    return self->nCount;
+}
+
+void MoveTail(CircularBuffer *self, uint32_t nSize)
+{
+    self->nTail = IndexAdvance(self, self->nTail, nSize);
+
+    // free-running indexes already tell full from empty
+    if (!(self->init.nFlags & LIBCB_FLAG_POWEROFTWO))
+    {
+        self->nCount += nSize;
+    }
+}
+
+void MoveHead(CircularBuffer *self, uint32_t nSize)
+{
+    self->nHead = IndexAdvance(self, self->nHead, nSize);
+
+    if (!(self->init.nFlags & LIBCB_FLAG_POWEROFTWO))
+    {
+        self->nCount -= nSize;
+    }
+}
+
+void CopyToBuffer(CircularBuffer *self, CircularBufferCopyFn pfnCopy, uint32_t nOffset, const void *pSource, uint32_t nSize)
+{
+    // the second mapping of a mirrored buffer absorbs the wrap
+    if (nOffset + nSize > self->init.nBufferSize && !(self->init.nFlags & LIBCB_FLAG_MIRRORED))
+    {
+        uint32_t nFirstCopySize = self->init.nBufferSize - nOffset;
+        uint32_t nSecondCopySize = nSize - nFirstCopySize;
+
+        pfnCopy((uint8_t *)self->init.pBuffer + nOffset, pSource, nFirstCopySize);
+        pfnCopy(self->init.pBuffer, (const uint8_t *)pSource + nFirstCopySize, nSecondCopySize);
+    }
+    else
+    {
+        pfnCopy((uint8_t *)self->init.pBuffer + nOffset, pSource, nSize);
+    }
+}
+
+void CopyFromBuffer(CircularBuffer *self, CircularBufferCopyFn pfnCopy, uint32_t nOffset, void *pDestination, uint32_t nSize)
+{
+    if (nOffset + nSize > self->init.nBufferSize && !(self->init.nFlags & LIBCB_FLAG_MIRRORED))
+    {
+        uint32_t nFirstCopySize = self->init.nBufferSize - nOffset;
+        uint32_t nSecondCopySize = nSize - nFirstCopySize;
+
+        pfnCopy(pDestination, (uint8_t *)self->init.pBuffer + nOffset, nFirstCopySize);
+        pfnCopy((uint8_t *)pDestination + nFirstCopySize, self->init.pBuffer, nSecondCopySize);
+    }
+    else
+    {
+        pfnCopy(pDestination, (uint8_t *)self->init.pBuffer + nOffset, nSize);
+    }
+}
+
+uint32_t CopyToBufferCrc(CircularBuffer *self, uint32_t nOffset, const void *pSource, uint32_t nSize, uint32_t nCrc)
+{
+    if (nOffset + nSize > self->init.nBufferSize && !(self->init.nFlags & LIBCB_FLAG_MIRRORED))
+    {
+        uint32_t nFirstCopySize = self->init.nBufferSize - nOffset;
+        uint32_t nSecondCopySize = nSize - nFirstCopySize;
+
+        nCrc = circularBufferCrc32cCopy(nCrc, (uint8_t *)self->init.pBuffer + nOffset, pSource, nFirstCopySize);
+        nCrc = circularBufferCrc32cCopy(nCrc, self->init.pBuffer, (const uint8_t *)pSource + nFirstCopySize, nSecondCopySize);
+    }
+    else
+    {
+        nCrc = circularBufferCrc32cCopy(nCrc, (uint8_t *)self->init.pBuffer + nOffset, pSource, nSize);
+    }
+
+    return nCrc;
+}
+
+uint32_t CopyFromBufferCrc(CircularBuffer *self, uint32_t nOffset, void *pDestination, uint32_t nSize, uint32_t nCrc)
+{
+    if (nOffset + nSize > self->init.nBufferSize && !(self->init.nFlags & LIBCB_FLAG_MIRRORED))
+    {
+        uint32_t nFirstCopySize = self->init.nBufferSize - nOffset;
+        uint32_t nSecondCopySize = nSize - nFirstCopySize;
+
+        nCrc = circularBufferCrc32cCopy(nCrc, pDestination, (uint8_t *)self->init.pBuffer + nOffset, nFirstCopySize);
+        nCrc = circularBufferCrc32cCopy(nCrc, (uint8_t *)pDestination + nFirstCopySize, self->init.pBuffer, nSecondCopySize);
+    }
+    else
+    {
+        nCrc = circularBufferCrc32cCopy(nCrc, pDestination, (uint8_t *)self->init.pBuffer + nOffset, nSize);
+    }
+
+    return nCrc;
+}
+
+void FoldPushedCrc(CircularBuffer *self, uint32_t nOffset, uint32_t nSize)
+{
+    if (self->init.nFlags & LIBCB_FLAG_CRC)
+    {
+        CircularBufferSpan aSpans[2];
+
+        GetSpans(self, nOffset, nSize, aSpans);
+        self->nPushedCrc = circularBufferCrc32c(self->nPushedCrc, aSpans[0].pData, aSpans[0].nSize);
+        self->nPushedCrc = circularBufferCrc32c(self->nPushedCrc, aSpans[1].pData, aSpans[1].nSize);
+    }
+}
+
+void GetSpans(CircularBuffer *self, uint32_t nOffset, uint32_t nSize, CircularBufferSpan aSpans[2])
+{
+    uint32_t nFirstSize;
+
+    if (nOffset >= self->init.nBufferSize)
+    {
+        nOffset -= self->init.nBufferSize;
+    }
+
+    nFirstSize = self->init.nBufferSize - nOffset;
+
+    if (nFirstSize > nSize || (self->init.nFlags & LIBCB_FLAG_MIRRORED))
+    {
+        nFirstSize = nSize;
+    }
+
+    aSpans[0].pData = (uint8_t *)self->init.pBuffer + nOffset;
+    aSpans[0].nSize = nFirstSize;
+    aSpans[1].pData = self->init.pBuffer;
+    aSpans[1].nSize = nSize - nFirstSize;
+}
+
+int32_t SearchSpans(const CircularBufferSpan aSpans[2], const uint8_t *pPattern, uint32_t nPatternSize)
+{
+    int32_t status = LIBCB_NOTFOUND;
+    uint32_t nTotal = aSpans[0].nSize + aSpans[1].nSize;
+    uint32_t nPosition = 0;
+
+    // a match starts before nCandidates so the whole pattern fits behind it
+    uint32_t nCandidates = nPatternSize <= nTotal ? nTotal - nPatternSize + 1 : 0;
+
+    while (nPosition < nCandidates)
+    {
+        const uint8_t *pStart;
+        uint32_t nLength;
+
+        if (nPosition < aSpans[0].nSize)
+        {
+            pStart = (const uint8_t *)aSpans[0].pData + nPosition;
+            nLength = aSpans[0].nSize - nPosition;
+        }
+        else
+        {
+            pStart = (const uint8_t *)aSpans[1].pData + (nPosition - aSpans[0].nSize);
+            nLength = nTotal - nPosition;
+        }
+
+        if (nLength > nCandidates - nPosition)
+        {
+            nLength = nCandidates - nPosition;
+        }
+
+        const uint8_t *pFound = (const uint8_t *)memchr(pStart, pPattern[0], nLength);
+
+        if (pFound == NULL)
+        {
+            nPosition += nLength;
+            continue;
+        }
+
+        nPosition += (uint32_t)(pFound - pStart);
+
+        if (MatchSpans(aSpans, nPosition + 1, pPattern + 1, nPatternSize - 1))
+        {
+            status = (int32_t)nPosition;
+            break;
+        }
+
+        nPosition++;
+    }
+
+    return status;
+}
+
+uint8_t MatchSpans(const CircularBufferSpan aSpans[2], uint32_t nPosition, const uint8_t *pPattern, uint32_t nPatternSize)
+{
+    uint8_t bMatch = TRUE;
+
+    while (bMatch && nPatternSize != 0)
+    {
+        const uint8_t *pStart;
+        uint32_t nLength = nPatternSize;
+
+        if (nPosition < aSpans[0].nSize)
+        {
+            pStart = (const uint8_t *)aSpans[0].pData + nPosition;
+
+            if (nLength > aSpans[0].nSize - nPosition)
+            {
+                nLength = aSpans[0].nSize - nPosition;
+            }
+        }
+        else
+        {
+            pStart = (const uint8_t *)aSpans[1].pData + (nPosition - aSpans[0].nSize);
+        }
+
+        bMatch = memcmp(pStart, pPattern, nLength) == 0;
+
+        nPosition += nLength;
+        pPattern += nLength;
+        nPatternSize -= nLength;
+    }
+
+    return bMatch;
+}
+
+int32_t WriteRecord(CircularBuffer *self, uint32_t nTail, uint32_t nFree, const void *pSource, uint32_t nSize, uint32_t *pnWritten)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        uint32_t nOffset = IndexToOffset(self, nTail);
+        uint32_t nPadding = 0;
+        uint32_t nTrailer = (self->init.nFlags & LIBCB_FLAG_RECORDCRC) ? LIBCB_RECORD_CRC_SIZE : 0;
+        uint32_t nHeader = nSize + nTrailer;
+
+        if (nSize > self->init.nBufferSize - LIBCB_RECORD_HEADER_SIZE - nTrailer || nHeader == RECORD_PADDING)
+        {
+            status = LIBCB_BUFFEROVERFLOW;
+            break;
+        }
+
+        if (
+            (self->init.nFlags & LIBCB_FLAG_RECORDNOWRAP) &&
+            !(self->init.nFlags & LIBCB_FLAG_MIRRORED) &&
+            nOffset + LIBCB_RECORD_HEADER_SIZE + nHeader > self->init.nBufferSize
+            )
+        {
+            // skip the rest of the buffer, the record starts over at offset 0
+            nPadding = self->init.nBufferSize - nOffset;
+        }
+
+        if (nFree < nPadding + LIBCB_RECORD_HEADER_SIZE + nHeader)
+        {
+            status = LIBCB_BUFFEROVERFLOW;
+            break;
+        }
+
+        // a tail too short for a header is skipped by the reader implicitly
+        if (nPadding >= LIBCB_RECORD_HEADER_SIZE)
+        {
+            uint32_t nMarker = RECORD_PADDING;
+
+            CopyToBuffer(self, self->pfnCopy, nOffset, &nMarker, sizeof(nMarker));
+        }
+
+        nOffset = IndexToOffset(self, IndexAdvance(self, nTail, nPadding));
+
+        CopyToBuffer(self, self->pfnCopy, nOffset, &nHeader, sizeof(nHeader));
+
+        nOffset = IndexToOffset(self, IndexAdvance(self, nTail, nPadding + LIBCB_RECORD_HEADER_SIZE));
+
+        if (nTrailer != 0)
+        {
+            uint32_t nCrc = CopyToBufferCrc(self, nOffset, pSource, nSize, 0);
+
+            CopyToBuffer(self, self->pfnCopy, IndexToOffset(self, IndexAdvance(self, nTail, nPadding + LIBCB_RECORD_HEADER_SIZE + nSize)), &nCrc, sizeof(nCrc));
+        }
+        else
+        {
+            CopyToBuffer(self, self->pfnCopy, nOffset, pSource, nSize);
+        }
+
+        *pnWritten = nPadding + LIBCB_RECORD_HEADER_SIZE + nHeader;
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t ParseRecord(CircularBuffer *self, uint32_t nHead, uint32_t nUsed, uint32_t *pnSkip, uint32_t *pnSize)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        uint32_t nOffset = IndexToOffset(self, nHead);
+        uint32_t nHeader = 0;
+
+        *pnSkip = 0;
+
+        if (nUsed == 0)
+        {
+            status = LIBCB_BUFFEREMPTY;
+            break;
+        }
+
+        if ((self->init.nFlags & LIBCB_FLAG_RECORDNOWRAP) && !(self->init.nFlags & LIBCB_FLAG_MIRRORED))
+        {
+            if (self->init.nBufferSize - nOffset < LIBCB_RECORD_HEADER_SIZE)
+            {
+                *pnSkip = self->init.nBufferSize - nOffset;
+            }
+            else
+            {
+                CopyFromBuffer(self, self->pfnCopyOut, nOffset, &nHeader, sizeof(nHeader));
+
+                if (nHeader == RECORD_PADDING)
+                {
+                    *pnSkip = self->init.nBufferSize - nOffset;
+                }
+            }
+
+            nOffset = (nOffset + *pnSkip) % self->init.nBufferSize;
+        }
+
+        // padding is only ever written in front of a record
+        if (nUsed < *pnSkip + LIBCB_RECORD_HEADER_SIZE)
+        {
+            status = LIBCB_BUFFERUNDERFLOW;
+            break;
+        }
+
+        CopyFromBuffer(self, self->pfnCopyOut, nOffset, &nHeader, sizeof(nHeader));
+
+        if (nUsed < *pnSkip + LIBCB_RECORD_HEADER_SIZE + nHeader)
+        {
+            status = LIBCB_BUFFERUNDERFLOW;
+            break;
+        }
+
+        *pnSize = nHeader;
+
+        break;
+    }
+
+    return status;
+}
+
+void DropOldest(CircularBuffer *self, uint32_t nRequired)
+{
+    while (self->init.nBufferSize - GetUsed(self) < nRequired && GetUsed(self) != 0)
+    {
+        uint32_t nDrop = nRequired - (self->init.nBufferSize - GetUsed(self));
+
+        if (self->init.nFlags & LIBCB_FLAG_RECORD)
+        {
+            uint32_t nSkip, nSize;
+
+            // a damaged record cannot be skipped, give up on the whole content
+            if (ParseRecord(self, self->nHead, GetUsed(self), &nSkip, &nSize) == LIBCB_SUCCESS)
+            {
+                nDrop = nSkip + LIBCB_RECORD_HEADER_SIZE + nSize;
+            }
+            else
+            {
+                nDrop = GetUsed(self);
+            }
+
+            self->nDroppedRecords++;
+        }
+
+        MoveHead(self, nDrop);
+        self->nDroppedBytes += nDrop;
+    }
+}
+
+void NotifyPushed(CircularBuffer *self)
+{
+    if (self->init.nFlags & (LIBCB_FLAG_BLOCKING | LIBCB_FLAG_EVENTFD))
+    {
+        // order the publish before the waiter check, pairs with BeginWait and ArmReadable
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+        if (__atomic_load_n(&self->nPopWaiters, __ATOMIC_RELAXED) != 0)
+        {
+            __atomic_add_fetch(&self->nPopSequence, 1, __ATOMIC_RELEASE);
+            circularBufferFutexWake(&self->nPopSequence, UINT32_MAX);
+        }
+
+        if (
+            __atomic_load_n(&self->nReadArmed, __ATOMIC_RELAXED) != 0 &&
+            __atomic_exchange_n(&self->nReadArmed, 0, __ATOMIC_RELAXED) != 0
+            )
+        {
+            circularBufferEventSignal(self->nReadableFd);
+        }
+    }
+}
+
+void NotifyPopped(CircularBuffer *self)
+{
+    if (self->init.nFlags & (LIBCB_FLAG_BLOCKING | LIBCB_FLAG_EVENTFD))
+    {
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+        if (__atomic_load_n(&self->nPushWaiters, __ATOMIC_RELAXED) != 0)
+        {
+            __atomic_add_fetch(&self->nPushSequence, 1, __ATOMIC_RELEASE);
+            circularBufferFutexWake(&self->nPushSequence, UINT32_MAX);
+        }
+
+        if (
+            __atomic_load_n(&self->nWriteArmed, __ATOMIC_RELAXED) != 0 &&
+            __atomic_exchange_n(&self->nWriteArmed, 0, __ATOMIC_RELAXED) != 0
+            )
+        {
+            circularBufferEventSignal(self->nWritableFd);
+        }
+    }
+}
+
+void ArmReadable(CircularBuffer *self, uint32_t nRequired)
+{
+    uint32_t nUsed;
+
+    if (self->init.nFlags & LIBCB_FLAG_EVENTFD)
+    {
+        __atomic_store_n(&self->nReadArmed, 1, __ATOMIC_RELAXED);
+
+        // a push that completed before the store above did not see it, check
+        // again and signal on its behalf
+        if (self->init.nFlags & LIBCB_FLAG_SPSC)
+        {
+            __atomic_thread_fence(__ATOMIC_SEQ_CST);
+            nUsed = IndexDistance(self, __atomic_load_n(&self->nHead, __ATOMIC_RELAXED), LoadTail(self));
+        }
+        else if (LockUncounted(self) == LIBCB_SUCCESS)
+        {
+            nUsed = GetUsed(self);
+            Release(self);
+        }
+        else
+        {
+            nUsed = 0;
+        }
+
+        if (nUsed >= nRequired && __atomic_exchange_n(&self->nReadArmed, 0, __ATOMIC_RELAXED) != 0)
+        {
+            circularBufferEventSignal(self->nReadableFd);
+        }
+    }
+}
+
+void ArmWritable(CircularBuffer *self, uint32_t nRequired)
+{
+    uint32_t nFree;
+
+    if (self->init.nFlags & LIBCB_FLAG_EVENTFD)
+    {
+        __atomic_store_n(&self->nWriteArmed, 1, __ATOMIC_RELAXED);
+
+        if (self->init.nFlags & LIBCB_FLAG_SPSC)
+        {
+            __atomic_thread_fence(__ATOMIC_SEQ_CST);
+            nFree = self->init.nBufferSize - IndexDistance(self, LoadHead(self), __atomic_load_n(&self->nTail, __ATOMIC_RELAXED));
+        }
+        else if (LockUncounted(self) == LIBCB_SUCCESS)
+        {
+            nFree = self->init.nBufferSize - GetUsed(self);
+            Release(self);
+        }
+        else
+        {
+            nFree = 0;
+        }
+
+        if (nFree >= nRequired && __atomic_exchange_n(&self->nWriteArmed, 0, __ATOMIC_RELAXED) != 0)
+        {
+            circularBufferEventSignal(self->nWritableFd);
+        }
+    }
+}
+
+uint32_t BeginWait(uint32_t *pSequence, uint32_t *pWaiters)
+{
+    uint32_t nSequence = __atomic_load_n(pSequence, __ATOMIC_ACQUIRE);
+
+    // the retry that follows must observe every publish that missed this
+    // waiter, pairs with the fence in NotifyPushed/NotifyPopped
+    __atomic_add_fetch(pWaiters, 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    return nSequence;
+}
+
+uint32_t LoadHead(CircularBuffer *self)
+{
+    self->nCachedHead = __atomic_load_n(&self->nHead, __ATOMIC_ACQUIRE);
+
+    return self->nCachedHead;
+}
+
+uint32_t LoadTail(CircularBuffer *self)
+{
+    self->nCachedTail = __atomic_load_n(&self->nTail, __ATOMIC_ACQUIRE);
+
+    return self->nCachedTail;
+}
+
+void CountPushed(CircularBuffer *self, uint32_t nSize)
+{
+#ifdef LIBCB_ENABLE_STATISTICS
+    uint32_t nUsed;
+
+    // a partial call that moved nothing was rejected, not accepted
+    if (nSize == 0)
+    {
+        return;
+    }
+
+    __atomic_fetch_add(&self->nStatPushedBytes, nSize, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&self->nStatPushes, 1, __ATOMIC_RELAXED);
+
+    if (self->init.nFlags & LIBCB_FLAG_SPSC)
+    {
+        uint32_t nTail = __atomic_load_n(&self->nTail, __ATOMIC_RELAXED);
+
+        // the cached head can only overstate the count, the real head is only
+        // loaded when that bound would raise the mark
+        nUsed = IndexDistance(self, self->nCachedHead, nTail);
+
+        if (nUsed > __atomic_load_n(&self->nStatHighWater, __ATOMIC_RELAXED))
+        {
+            nUsed = IndexDistance(self, LoadHead(self), nTail);
+        }
+    }
+    else
+    {
+        // the locked modes call this with the lock held
+        nUsed = GetUsed(self);
+    }
+
+    if (nUsed > __atomic_load_n(&self->nStatHighWater, __ATOMIC_RELAXED))
+    {
+        __atomic_store_n(&self->nStatHighWater, nUsed, __ATOMIC_RELAXED);
+    }
+#else
+    (void)self;
+    (void)nSize;
+#endif
+}
+
+void CountPopped(CircularBuffer *self, uint32_t nSize)
+{
+#ifdef LIBCB_ENABLE_STATISTICS
+    if (nSize != 0)
+    {
+        __atomic_fetch_add(&self->nStatPoppedBytes, nSize, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&self->nStatPops, 1, __ATOMIC_RELAXED);
+    }
+#else
+    (void)self;
+    (void)nSize;
+#endif
+}
+
+void CountOverflow(CircularBuffer *self)
+{
+#ifdef LIBCB_ENABLE_STATISTICS
+    __atomic_fetch_add(&self->nStatOverflows, 1, __ATOMIC_RELAXED);
+#else
+    (void)self;
+#endif
+}
+
+void CountUnderflow(CircularBuffer *self)
+{
+#ifdef LIBCB_ENABLE_STATISTICS
+    __atomic_fetch_add(&self->nStatUnderflows, 1, __ATOMIC_RELAXED);
+#else
+    (void)self;
+#endif
+}
+
+#ifdef LIBCB_ENABLE_STATISTICS
+void CountLockWait(CircularBuffer *self, uint64_t nStart)
+{
+    uint64_t nWait = circularBufferMonotonicTime() - nStart;
+    uint64_t nMax = __atomic_load_n(&self->nStatLockWaitMaxNs, __ATOMIC_RELAXED);
+
+    __atomic_fetch_add(&self->nStatLockAcquires, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&self->nStatLockWaitNs, nWait, __ATOMIC_RELAXED);
+
+    while (
+        nWait > nMax &&
+        !__atomic_compare_exchange_n(&self->nStatLockWaitMaxNs, &nMax, nWait, TRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED)
+        )
+    {
+    }
+}
+
+uint64_t ReadCounter(uint64_t *pnCounter, uint8_t bReset)
+{
+    return bReset ? __atomic_exchange_n(pnCounter, 0, __ATOMIC_RELAXED) : __atomic_load_n(pnCounter, __ATOMIC_RELAXED);
+}
+#endif
+
+int32_t PushLockFree(CircularBuffer *self, CircularBufferCopyFn pfnCopy, const void *pSource, uint32_t nSourceSize)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        // the tail is owned by the producer, the head is published by the consumer
+        uint32_t nTail = __atomic_load_n(&self->nTail, __ATOMIC_RELAXED);
+
+        // the cached head is never ahead of the real one, only refresh it when
+        // the buffer looks too full
+        if (
+            self->init.nBufferSize - IndexDistance(self, self->nCachedHead, nTail) < nSourceSize &&
+            self->init.nBufferSize - IndexDistance(self, LoadHead(self), nTail) < nSourceSize
+            )
+        {
+            status = LIBCB_BUFFEROVERFLOW;
+            break;
+        }
+
+        if (self->init.nFlags & LIBCB_FLAG_CRC)
+        {
+            self->nPushedCrc = CopyToBufferCrc(self, IndexToOffset(self, nTail), pSource, nSourceSize, self->nPushedCrc);
+        }
+        else
+        {
+            CopyToBuffer(self, pfnCopy, IndexToOffset(self, nTail), pSource, nSourceSize);
+        }
+
+        __atomic_store_n(&self->nTail, IndexAdvance(self, nTail, nSourceSize), __ATOMIC_RELEASE);
+        CountPushed(self, nSourceSize);
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t PopLockFree(CircularBuffer *self, CircularBufferCopyFn pfnCopy, void *pDestination, uint32_t nDestinationSize)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        // the head is owned by the consumer, the tail is published by the producer
+        uint32_t nHead = __atomic_load_n(&self->nHead, __ATOMIC_RELAXED);
+        uint32_t nUsed = IndexDistance(self, nHead, self->nCachedTail);
+
+        // the cached tail is never ahead of the real one, only refresh it when
+        // the buffer looks too empty
+        if (nUsed < nDestinationSize)
+        {
+            nUsed = IndexDistance(self, nHead, LoadTail(self));
+        }
+
+        if (nUsed == 0)
+        {
+            status = LIBCB_BUFFEREMPTY;
+            break;
+        }
+
+        if (nUsed < nDestinationSize)
+        {
+            status = LIBCB_BUFFERUNDERFLOW;
+            break;
+        }
+
+        CopyFromBuffer(self, pfnCopy, IndexToOffset(self, nHead), pDestination, nDestinationSize);
+
+        __atomic_store_n(&self->nHead, IndexAdvance(self, nHead, nDestinationSize), __ATOMIC_RELEASE);
+        CountPopped(self, nDestinationSize);
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t MoveStorage(CircularBuffer *self, void *pBuffer, uint32_t nBufferSize)
+{
+    int32_t status = LIBCB_SUCCESS;
+    uint32_t nUsed = GetUsed(self);
+    uint32_t nMoved = 0;
+
+    if (self->init.nFlags & LIBCB_FLAG_RECORDNOWRAP)
+    {
+        uint32_t nHead = self->nHead;
+        uint32_t nSkip, nSize;
+
+        // records are packed back to back, the padding in front of them stays behind
+        while (nUsed != 0 && status == LIBCB_SUCCESS)
+        {
+            status = ParseRecord(self, nHead, nUsed, &nSkip, &nSize);
+
+            if (status != LIBCB_SUCCESS)
+            {
+                break;
+            }
+
+            uint32_t nRecord = LIBCB_RECORD_HEADER_SIZE + nSize;
+
+            if (nBufferSize - nMoved < nRecord)
+            {
+                status = LIBCB_BUFFEROVERFLOW;
+                break;
+            }
+
+            CopyFromBuffer(self, self->pfnCopy, IndexToOffset(self, IndexAdvance(self, nHead, nSkip)), (uint8_t *)pBuffer + nMoved, nRecord);
+
+            nMoved += nRecord;
+            nHead = IndexAdvance(self, nHead, nSkip + nRecord);
+            nUsed -= nSkip + nRecord;
+        }
+    }
+    else if (nUsed > nBufferSize)
+    {
+        status = LIBCB_BUFFEROVERFLOW;
+    }
+    else if (nUsed != 0)
+    {
+        CopyFromBuffer(self, self->pfnCopy, IndexToOffset(self, self->nHead), pBuffer, nUsed);
+        nMoved = nUsed;
+    }
+
+    if (status == LIBCB_SUCCESS)
+    {
+        // the oldest byte sits at offset 0 now, both index schemes start over from there
+        // each field is stored atomically for the unlocked checks that read one
+        // of them, only the lock makes the pair consistent, so everything that
+        // touches the storage holds it
+        __atomic_store_n(&self->init.pBuffer, pBuffer, __ATOMIC_RELAXED);
+        __atomic_store_n(&self->init.nBufferSize, nBufferSize, __ATOMIC_RELAXED);
+        self->nHead = 0;
+        self->nTail = nMoved;
+        self->nCount = nMoved;
+    }
+
+    return status;
+}
+
+int32_t Reallocate(CircularBuffer *self, uint32_t nBufferSize)
+{
+    int32_t status = LIBCB_BUFFEROVERFLOW;
+    const CircularBufferResizePolicy *pPolicy = self->pResizePolicy;
+    void *pOldBuffer = self->init.pBuffer;
+    uint32_t nOldSize = self->init.nBufferSize;
+    void *pBuffer = pPolicy->pfnAllocate(nBufferSize, pPolicy->pContext);
+
+    if (pBuffer != NULL)
+    {
+        status = MoveStorage(self, pBuffer, nBufferSize);
+
+        if (status == LIBCB_SUCCESS)
+        {
+            pPolicy->pfnFree(pOldBuffer, nOldSize, pPolicy->pContext);
+        }
+        else
+        {
+            pPolicy->pfnFree(pBuffer, nBufferSize, pPolicy->pContext);
+        }
+    }
+
+    return status;
+}
+
+int32_t Grow(CircularBuffer *self, uint32_t nFree)
+{
+    int32_t status = LIBCB_BUFFEROVERFLOW;
+    const CircularBufferResizePolicy *pPolicy = self->pResizePolicy;
+    uint32_t nSize = self->init.nBufferSize;
+
+    // the ceiling bounds the stored data plus the room asked for
+    if (nSize < pPolicy->nMaxSize && nFree <= pPolicy->nMaxSize - GetUsed(self))
+    {
+        uint32_t nRequired = GetUsed(self) + nFree;
+
+        do
+        {
+            nSize = nSize > pPolicy->nMaxSize / 2 ? pPolicy->nMaxSize : nSize * 2;
+        } while (nSize < nRequired);
+
+        status = Reallocate(self, nSize);
+    }
+
+    return status;
+}
+
+void Shrink(CircularBuffer *self, uint32_t nUsed)
+{
+    const CircularBufferResizePolicy *pPolicy = self->pResizePolicy;
+
+    // between two pops the count only grows, so the count in front of every
+    // pop is the peak of the interval
+    if (pPolicy != NULL && pPolicy->nMinSize != 0)
+    {
+        if (nUsed > self->nResizePeak)
+        {
+            self->nResizePeak = nUsed;
+        }
+
+        if (++self->nResizePops >= pPolicy->nShrinkAfter)
+        {
+            // a quarter leaves half of the smaller storage as headroom
+            if (self->nResizePeak <= self->init.nBufferSize / 4 && self->init.nBufferSize / 2 >= pPolicy->nMinSize)
+            {
+                Reallocate(self, self->init.nBufferSize / 2);
+            }
+
+            self->nResizePeak = GetUsed(self);
+            self->nResizePops = 0;
+        }
+    }
+}
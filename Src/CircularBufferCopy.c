@@ -0,0 +1,253 @@
+#include <string.h>
+#include "CircularBufferPrivate.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define COPY_X86 1
+#include <immintrin.h>
+#endif
+
+// Copy with the C library
+static void CopyMemcpy(void *pDestination, const void *pSource, uint32_t nSize);
+
+#ifdef COPY_X86
+// Copy 128 bytes per step with unaligned AVX2 loads and stores
+static void CopyAvx2(void *pDestination, const void *pSource, uint32_t nSize);
+
+// Copy 256 bytes per step with unaligned AVX-512 loads and stores
+static void CopyAvx512(void *pDestination, const void *pSource, uint32_t nSize);
+
+// Copy with SSE2 non-temporal stores to the 16 byte aligned part of the destination
+static void CopyStreamSse2(void *pDestination, const void *pSource, uint32_t nSize);
+
+// Copy with AVX2 non-temporal stores to the 32 byte aligned part of the destination
+static void CopyStreamAvx2(void *pDestination, const void *pSource, uint32_t nSize);
+
+// memcpy below LIBCB_COPY_STREAM_THRESHOLD, SSE2 streaming from there on
+static void CopyAutoSse2(void *pDestination, const void *pSource, uint32_t nSize);
+
+// memcpy below LIBCB_COPY_STREAM_THRESHOLD, AVX2 streaming from there on
+static void CopyAutoAvx2(void *pDestination, const void *pSource, uint32_t nSize);
+#endif
+
+int32_t circularBufferCopySelect(uint32_t nCopy, CircularBufferCopyFn *ppfnCopy)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    switch (nCopy & LIBCB_FLAG_COPYMASK)
+    {
+    case LIBCB_FLAG_COPYMEMCPY:
+        *ppfnCopy = CopyMemcpy;
+        break;
+#ifdef COPY_X86
+    case LIBCB_FLAG_COPYAUTO:
+        *ppfnCopy = __builtin_cpu_supports("avx2") ? CopyAutoAvx2 : CopyAutoSse2;
+        break;
+    case LIBCB_FLAG_COPYAVX2:
+        *ppfnCopy = CopyAvx2;
+        status = __builtin_cpu_supports("avx2") ? LIBCB_SUCCESS : LIBCB_NOTSUPPORTED;
+        break;
+    case LIBCB_FLAG_COPYAVX512:
+        *ppfnCopy = CopyAvx512;
+        status = __builtin_cpu_supports("avx512f") ? LIBCB_SUCCESS : LIBCB_NOTSUPPORTED;
+        break;
+    case LIBCB_FLAG_COPYSTREAM:
+        *ppfnCopy = __builtin_cpu_supports("avx2") ? CopyStreamAvx2 : CopyStreamSse2;
+        status = __builtin_cpu_supports("sse2") ? LIBCB_SUCCESS : LIBCB_NOTSUPPORTED;
+        break;
+#else
+    case LIBCB_FLAG_COPYAUTO:
+        // without streaming stores the automatic choice is the C library
+        *ppfnCopy = CopyMemcpy;
+        break;
+    case LIBCB_FLAG_COPYAVX2:
+    case LIBCB_FLAG_COPYAVX512:
+    case LIBCB_FLAG_COPYSTREAM:
+        status = LIBCB_NOTSUPPORTED;
+        break;
+#endif
+    default:
+        status = LIBCB_INVALIDPARAM;
+        break;
+    }
+
+    return status;
+}
+
+int32_t circularBufferCopySelectOut(uint32_t nCopy, CircularBufferCopyFn *ppfnCopy)
+{
+    int32_t status = circularBufferCopySelect(nCopy, ppfnCopy);
+
+#ifdef COPY_X86
+    if (status == LIBCB_SUCCESS && (nCopy & LIBCB_FLAG_COPYMASK) == LIBCB_FLAG_COPYSTREAM)
+    {
+        *ppfnCopy = __builtin_cpu_supports("avx2") ? CopyAvx2 : CopyMemcpy;
+    }
+    else if (status == LIBCB_SUCCESS && (nCopy & LIBCB_FLAG_COPYMASK) == LIBCB_FLAG_COPYAUTO)
+    {
+        *ppfnCopy = CopyMemcpy;
+    }
+#endif
+
+    return status;
+}
+
+void CopyMemcpy(void *pDestination, const void *pSource, uint32_t nSize)
+{
+    memcpy(pDestination, pSource, nSize);
+}
+
+#ifdef COPY_X86
+
+__attribute__((target("avx2")))
+void CopyAvx2(void *pDestination, const void *pSource, uint32_t nSize)
+{
+    uint8_t *pTo = (uint8_t *)pDestination;
+    const uint8_t *pFrom = (const uint8_t *)pSource;
+
+    for (; nSize >= 128; nSize -= 128, pTo += 128, pFrom += 128)
+    {
+        __m256i v0 = _mm256_loadu_si256((const __m256i *)pFrom);
+        __m256i v1 = _mm256_loadu_si256((const __m256i *)(pFrom + 32));
+        __m256i v2 = _mm256_loadu_si256((const __m256i *)(pFrom + 64));
+        __m256i v3 = _mm256_loadu_si256((const __m256i *)(pFrom + 96));
+
+        _mm256_storeu_si256((__m256i *)pTo, v0);
+        _mm256_storeu_si256((__m256i *)(pTo + 32), v1);
+        _mm256_storeu_si256((__m256i *)(pTo + 64), v2);
+        _mm256_storeu_si256((__m256i *)(pTo + 96), v3);
+    }
+
+    for (; nSize >= 32; nSize -= 32, pTo += 32, pFrom += 32)
+    {
+        _mm256_storeu_si256((__m256i *)pTo, _mm256_loadu_si256((const __m256i *)pFrom));
+    }
+
+    memcpy(pTo, pFrom, nSize);
+}
+
+__attribute__((target("avx512f")))
+void CopyAvx512(void *pDestination, const void *pSource, uint32_t nSize)
+{
+    uint8_t *pTo = (uint8_t *)pDestination;
+    const uint8_t *pFrom = (const uint8_t *)pSource;
+
+    for (; nSize >= 256; nSize -= 256, pTo += 256, pFrom += 256)
+    {
+        __m512i v0 = _mm512_loadu_si512((const void *)pFrom);
+        __m512i v1 = _mm512_loadu_si512((const void *)(pFrom + 64));
+        __m512i v2 = _mm512_loadu_si512((const void *)(pFrom + 128));
+        __m512i v3 = _mm512_loadu_si512((const void *)(pFrom + 192));
+
+        _mm512_storeu_si512((void *)pTo, v0);
+        _mm512_storeu_si512((void *)(pTo + 64), v1);
+        _mm512_storeu_si512((void *)(pTo + 128), v2);
+        _mm512_storeu_si512((void *)(pTo + 192), v3);
+    }
+
+    for (; nSize >= 64; nSize -= 64, pTo += 64, pFrom += 64)
+    {
+        _mm512_storeu_si512((void *)pTo, _mm512_loadu_si512((const void *)pFrom));
+    }
+
+    memcpy(pTo, pFrom, nSize);
+}
+
+__attribute__((target("sse2")))
+void CopyStreamSse2(void *pDestination, const void *pSource, uint32_t nSize)
+{
+    uint8_t *pTo = (uint8_t *)pDestination;
+    const uint8_t *pFrom = (const uint8_t *)pSource;
+    uint32_t nAlign = (uint32_t)(-(uintptr_t)pTo & 15u);
+
+    if (nSize < nAlign + 64)
+    {
+        memcpy(pTo, pFrom, nSize);
+        return;
+    }
+
+    memcpy(pTo, pFrom, nAlign);
+    pTo += nAlign;
+    pFrom += nAlign;
+    nSize -= nAlign;
+
+    for (; nSize >= 64; nSize -= 64, pTo += 64, pFrom += 64)
+    {
+        __m128i v0 = _mm_loadu_si128((const __m128i *)pFrom);
+        __m128i v1 = _mm_loadu_si128((const __m128i *)(pFrom + 16));
+        __m128i v2 = _mm_loadu_si128((const __m128i *)(pFrom + 32));
+        __m128i v3 = _mm_loadu_si128((const __m128i *)(pFrom + 48));
+
+        _mm_stream_si128((__m128i *)pTo, v0);
+        _mm_stream_si128((__m128i *)(pTo + 16), v1);
+        _mm_stream_si128((__m128i *)(pTo + 32), v2);
+        _mm_stream_si128((__m128i *)(pTo + 48), v3);
+    }
+
+    // streaming stores are weakly ordered, the index that publishes them is not
+    _mm_sfence();
+
+    memcpy(pTo, pFrom, nSize);
+}
+
+__attribute__((target("avx2")))
+void CopyStreamAvx2(void *pDestination, const void *pSource, uint32_t nSize)
+{
+    uint8_t *pTo = (uint8_t *)pDestination;
+    const uint8_t *pFrom = (const uint8_t *)pSource;
+    uint32_t nAlign = (uint32_t)(-(uintptr_t)pTo & 31u);
+
+    if (nSize < nAlign + 128)
+    {
+        memcpy(pTo, pFrom, nSize);
+        return;
+    }
+
+    memcpy(pTo, pFrom, nAlign);
+    pTo += nAlign;
+    pFrom += nAlign;
+    nSize -= nAlign;
+
+    for (; nSize >= 128; nSize -= 128, pTo += 128, pFrom += 128)
+    {
+        __m256i v0 = _mm256_loadu_si256((const __m256i *)pFrom);
+        __m256i v1 = _mm256_loadu_si256((const __m256i *)(pFrom + 32));
+        __m256i v2 = _mm256_loadu_si256((const __m256i *)(pFrom + 64));
+        __m256i v3 = _mm256_loadu_si256((const __m256i *)(pFrom + 96));
+
+        _mm256_stream_si256((__m256i *)pTo, v0);
+        _mm256_stream_si256((__m256i *)(pTo + 32), v1);
+        _mm256_stream_si256((__m256i *)(pTo + 64), v2);
+        _mm256_stream_si256((__m256i *)(pTo + 96), v3);
+    }
+
+    // streaming stores are weakly ordered, the index that publishes them is not
+    _mm_sfence();
+
+    memcpy(pTo, pFrom, nSize);
+}
+
+void CopyAutoSse2(void *pDestination, const void *pSource, uint32_t nSize)
+{
+    if (nSize < LIBCB_COPY_STREAM_THRESHOLD)
+    {
+        memcpy(pDestination, pSource, nSize);
+    }
+    else
+    {
+        CopyStreamSse2(pDestination, pSource, nSize);
+    }
+}
+
+void CopyAutoAvx2(void *pDestination, const void *pSource, uint32_t nSize)
+{
+    if (nSize < LIBCB_COPY_STREAM_THRESHOLD)
+    {
+        memcpy(pDestination, pSource, nSize);
+    }
+    else
+    {
+        CopyStreamAvx2(pDestination, pSource, nSize);
+    }
+}
+
+#endif
@@ -0,0 +1,167 @@
+#include "CircularBufferPrivate.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <errno.h>
+#include <limits.h>
+#include <sys/uio.h>
+
+// Describe the spans as an iovec array and trim them to nSize bytes
+static int SpansToVectors(const CircularBufferSpan aSpans[2], uint32_t nSize, struct iovec aVectors[2]);
+
+// Map the errno of a failed readv/writev to a status code
+static int32_t ErrnoToStatus(int nError);
+
+int32_t circularBufferReadFromFd(CircularBuffer *self, int nFd, uint32_t nMaxSize)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (self == NULL || nFd < 0 || (self->init.nFlags & LIBCB_FLAG_RECORD))
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        CircularBufferSpan aSpans[2];
+        struct iovec aVectors[2];
+        uint32_t nFree;
+
+        // another producer may take the space between the count and the reserve
+        do
+        {
+            nFree = self->init.nBufferSize - (uint32_t)circularBufferGetCount(self);
+            nFree = nMaxSize != 0 && nMaxSize < nFree ? nMaxSize : nFree;
+            nFree = nFree < INT32_MAX ? nFree : INT32_MAX;
+
+            status = nFree == 0 ? LIBCB_BUFFERFULL : circularBufferReserve(self, nFree, aSpans);
+        } while (status == LIBCB_BUFFEROVERFLOW);
+
+        if (status != LIBCB_SUCCESS)
+        {
+            break;
+        }
+
+        ssize_t nRead;
+        int nVectors = SpansToVectors(aSpans, nFree, aVectors);
+
+        do
+        {
+            nRead = readv(nFd, aVectors, nVectors);
+        } while (nRead < 0 && errno == EINTR);
+
+        int nError = errno;
+
+        // end of file and errors only release the reservation, nobody is signalled
+        status = circularBufferCommit(self, nRead > 0 ? (uint32_t)nRead : 0);
+
+        if (nRead < 0)
+        {
+            status = ErrnoToStatus(nError);
+            errno = nError;
+        }
+        else if (status == LIBCB_SUCCESS)
+        {
+            status = (int32_t)nRead;
+        }
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t circularBufferWriteToFd(CircularBuffer *self, int nFd, uint32_t nMaxSize)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (self == NULL || nFd < 0 || (self->init.nFlags & LIBCB_FLAG_RECORD))
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        CircularBufferSpan aSpans[2];
+        struct iovec aVectors[2];
+
+        status = circularBufferPeek(self, aSpans);
+
+        if (status != LIBCB_SUCCESS)
+        {
+            break;
+        }
+
+        uint32_t nUsed = aSpans[0].nSize + aSpans[1].nSize;
+
+        nUsed = nMaxSize != 0 && nMaxSize < nUsed ? nMaxSize : nUsed;
+        nUsed = nUsed < INT32_MAX ? nUsed : INT32_MAX;
+
+        ssize_t nWritten;
+        int nVectors = SpansToVectors(aSpans, nUsed, aVectors);
+
+        do
+        {
+            nWritten = writev(nFd, aVectors, nVectors);
+        } while (nWritten < 0 && errno == EINTR);
+
+        int nError = errno;
+
+        status = circularBufferConsume(self, nWritten > 0 ? (uint32_t)nWritten : 0);
+
+        if (nWritten < 0)
+        {
+            status = ErrnoToStatus(nError);
+            errno = nError;
+        }
+        else if (status == LIBCB_SUCCESS)
+        {
+            status = (int32_t)nWritten;
+        }
+
+        break;
+    }
+
+    return status;
+}
+
+int SpansToVectors(const CircularBufferSpan aSpans[2], uint32_t nSize, struct iovec aVectors[2])
+{
+    uint32_t nFirst = aSpans[0].nSize < nSize ? aSpans[0].nSize : nSize;
+
+    aVectors[0].iov_base = aSpans[0].pData;
+    aVectors[0].iov_len = nFirst;
+    aVectors[1].iov_base = aSpans[1].pData;
+    aVectors[1].iov_len = nSize - nFirst;
+
+    return aVectors[1].iov_len != 0 ? 2 : 1;
+}
+
+int32_t ErrnoToStatus(int nError)
+{
+    return nError == EAGAIN || nError == EWOULDBLOCK ? LIBCB_WOULDBLOCK : LIBCB_SYSTEMERROR;
+}
+
+#else
+
+int32_t circularBufferReadFromFd(CircularBuffer *self, int nFd, uint32_t nMaxSize)
+{
+    (void)self;
+    (void)nFd;
+    (void)nMaxSize;
+
+    return LIBCB_NOTSUPPORTED;
+}
+
+int32_t circularBufferWriteToFd(CircularBuffer *self, int nFd, uint32_t nMaxSize)
+{
+    (void)self;
+    (void)nFd;
+    (void)nMaxSize;
+
+    return LIBCB_NOTSUPPORTED;
+}
+
+#endif
@@ -0,0 +1,708 @@
+#include <string.h>
+#include "libCircularBuffer/CircularBufferFile.h"
+#include "CircularBufferLock.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Size the new file, map it and write a fresh header
+static int32_t FormatFile(CircularBufferFile *self, int nFd, uint32_t nBufferSize, uint32_t nFlags);
+
+// Map an existing file, validate its header and recover the indexes, only an
+// exclusive opener repairs what a crashed run left behind
+static int32_t RecoverFile(CircularBufferFile *self, int nFd, off_t nFileSize, uint8_t bExclusive);
+
+// Drop the newest record if its length or its CRC32C does not match the data
+static void DiscardTornRecord(CircularBufferFile *self);
+
+// Copy into the storage starting at the index, wrapping if needed
+static void CopyToStorage(CircularBufferFile *self, uint32_t nIndex, const void *pSource, uint32_t nSize);
+
+// Copy out of the storage starting at the index, wrapping if needed
+static void CopyFromStorage(CircularBufferFile *self, uint32_t nIndex, void *pDestination, uint32_t nSize);
+
+// Write back the pages holding nSize bytes of storage from the index
+static int32_t SyncStorage(CircularBufferFile *self, uint32_t nIndex, uint32_t nSize, int nMode);
+
+// Write back the given pages of the mapping
+static int32_t SyncPages(CircularBufferFile *self, const uint8_t *pStart, uint32_t nSize, int nMode);
+
+// Publish the new indexes in the header and apply the sync policy, the data
+// range written by the operation goes to the file before the header does
+static int32_t CommitHeader(CircularBufferFile *self, uint32_t nIndex, uint32_t nSize);
+
+int32_t circularBufferFileOpen(CircularBufferFile *self, const char *pPath, uint32_t nBufferSize, uint32_t nFlags, uint32_t nSyncPolicy)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (
+            self == NULL || pPath == NULL || nFlags > LIBCB_FILE_FLAG_RECORD ||
+            nSyncPolicy > LIBCB_FILE_SYNC_ALWAYS
+            )
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        memset(self, 0, sizeof(CircularBufferFile));
+        self->nFd = -1;
+        self->nSyncPolicy = nSyncPolicy;
+        self->nPageSize = (uint32_t)sysconf(_SC_PAGESIZE);
+
+        int nFd = open(pPath, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+        struct stat info;
+        uint32_t nMagic = 0;
+
+        if (nFd < 0)
+        {
+            status = LIBCB_SYSTEMERROR;
+            break;
+        }
+
+        // every open handle holds a shared lock, so getting the exclusive one
+        // means no other handle is using the file right now
+        uint8_t bExclusive = flock(nFd, LOCK_EX | LOCK_NB) == 0;
+
+        if (
+            (!bExclusive && flock(nFd, LOCK_SH) != 0) ||
+            fstat(nFd, &info) != 0 ||
+            (info.st_size >= (off_t)sizeof(nMagic) && pread(nFd, &nMagic, sizeof(nMagic), 0) != (ssize_t)sizeof(nMagic))
+            )
+        {
+            status = LIBCB_SYSTEMERROR;
+        }
+        // an empty file was just created, a zero magic means its creator died
+        // before the header reached the disk
+        else if (bExclusive && nMagic == 0)
+        {
+            status = FormatFile(self, nFd, nBufferSize, nFlags);
+        }
+        else
+        {
+            status = RecoverFile(self, nFd, info.st_size, bExclusive);
+        }
+
+        if (status == LIBCB_SUCCESS && bExclusive && flock(nFd, LOCK_SH) != 0)
+        {
+            circularBufferFileClose(self);
+            status = LIBCB_SYSTEMERROR;
+        }
+
+        if (status != LIBCB_SUCCESS)
+        {
+            int nError = errno;
+
+            close(nFd);
+            errno = nError;
+            break;
+        }
+
+        self->nFd = nFd;
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t circularBufferFileClose(CircularBufferFile *self)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (self == NULL || self->pHeader == NULL)
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        status = circularBufferFileFlush(self);
+
+        if (munmap(self->pHeader, self->nMapSize) != 0)
+        {
+            status = LIBCB_SYSTEMERROR;
+        }
+
+        // closing the descriptor drops the shared lock of this handle
+        if (self->nFd >= 0)
+        {
+            close(self->nFd);
+        }
+
+        self->pHeader = NULL;
+        self->pData = NULL;
+        self->nMapSize = 0;
+        self->nFd = -1;
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t circularBufferFileFlush(CircularBufferFile *self)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (self == NULL || self->pHeader == NULL)
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        status = SyncPages(self, self->pData, self->pHeader->nBufferSize, MS_SYNC);
+
+        if (status != LIBCB_SUCCESS)
+        {
+            break;
+        }
+
+        status = SyncPages(self, (const uint8_t *)self->pHeader, self->pHeader->nDataOffset, MS_SYNC);
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t circularBufferFilePush(CircularBufferFile *self, const void *pSource, uint32_t nSourceSize)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (
+            self == NULL || self->pHeader == NULL || pSource == NULL || nSourceSize == 0 ||
+            (self->pHeader->nFlags & LIBCB_FILE_FLAG_RECORD)
+            )
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        CircularBufferFileHeader *pHeader = self->pHeader;
+
+        SpinLockAcquire(&pHeader->nLockWord);
+
+        uint32_t nTail = pHeader->nTail;
+
+        if (pHeader->nBufferSize - (nTail - pHeader->nHead) < nSourceSize)
+        {
+            SpinLockRelease(&pHeader->nLockWord);
+            status = LIBCB_BUFFEROVERFLOW;
+            break;
+        }
+
+        CopyToStorage(self, nTail, pSource, nSourceSize);
+        pHeader->nTail = nTail + nSourceSize;
+        pHeader->nLastRecord = pHeader->nTail;
+
+        status = CommitHeader(self, nTail, nSourceSize);
+
+        SpinLockRelease(&pHeader->nLockWord);
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t circularBufferFilePop(CircularBufferFile *self, void *pDestination, uint32_t nDestinationSize)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (
+            self == NULL || self->pHeader == NULL || pDestination == NULL || nDestinationSize == 0 ||
+            (self->pHeader->nFlags & LIBCB_FILE_FLAG_RECORD)
+            )
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        CircularBufferFileHeader *pHeader = self->pHeader;
+
+        SpinLockAcquire(&pHeader->nLockWord);
+
+        uint32_t nUsed = pHeader->nTail - pHeader->nHead;
+
+        if (nUsed < nDestinationSize)
+        {
+            SpinLockRelease(&pHeader->nLockWord);
+            status = nUsed == 0 ? LIBCB_BUFFEREMPTY : LIBCB_BUFFERUNDERFLOW;
+            break;
+        }
+
+        CopyFromStorage(self, pHeader->nHead, pDestination, nDestinationSize);
+        pHeader->nHead += nDestinationSize;
+
+        status = CommitHeader(self, 0, 0);
+
+        SpinLockRelease(&pHeader->nLockWord);
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t circularBufferFilePushRecord(CircularBufferFile *self, const void *pSource, uint32_t nSourceSize)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (
+            self == NULL || self->pHeader == NULL || pSource == NULL || nSourceSize == 0 ||
+            !(self->pHeader->nFlags & LIBCB_FILE_FLAG_RECORD)
+            )
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        CircularBufferFileHeader *pHeader = self->pHeader;
+
+        if (pHeader->nBufferSize < LIBCB_FILE_RECORD_HEADER_SIZE || pHeader->nBufferSize - LIBCB_FILE_RECORD_HEADER_SIZE < nSourceSize)
+        {
+            status = LIBCB_BUFFEROVERFLOW;
+            break;
+        }
+
+        // the checksum is taken outside the lock
+        uint32_t aRecordHeader[2] = { nSourceSize, circularBufferCrc32c(0, pSource, nSourceSize) };
+
+        SpinLockAcquire(&pHeader->nLockWord);
+
+        uint32_t nTail = pHeader->nTail;
+
+        if (pHeader->nBufferSize - (nTail - pHeader->nHead) < nSourceSize + LIBCB_FILE_RECORD_HEADER_SIZE)
+        {
+            SpinLockRelease(&pHeader->nLockWord);
+            status = LIBCB_BUFFEROVERFLOW;
+            break;
+        }
+
+        // records wrap like bytes do, there is no padding to skip on recovery
+        CopyToStorage(self, nTail, aRecordHeader, LIBCB_FILE_RECORD_HEADER_SIZE);
+        CopyToStorage(self, nTail + LIBCB_FILE_RECORD_HEADER_SIZE, pSource, nSourceSize);
+        pHeader->nLastRecord = nTail;
+        pHeader->nTail = nTail + LIBCB_FILE_RECORD_HEADER_SIZE + nSourceSize;
+
+        status = CommitHeader(self, nTail, LIBCB_FILE_RECORD_HEADER_SIZE + nSourceSize);
+
+        SpinLockRelease(&pHeader->nLockWord);
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t circularBufferFilePopRecord(CircularBufferFile *self, void *pDestination, uint32_t nDestinationSize, uint32_t *pnSize)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (
+            self == NULL || self->pHeader == NULL || pDestination == NULL ||
+            !(self->pHeader->nFlags & LIBCB_FILE_FLAG_RECORD)
+            )
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        CircularBufferFileHeader *pHeader = self->pHeader;
+        uint32_t aRecordHeader[2];
+
+        SpinLockAcquire(&pHeader->nLockWord);
+
+        uint32_t nHead = pHeader->nHead;
+
+        uint32_t nUsed = pHeader->nTail - nHead;
+
+        if (nUsed == 0)
+        {
+            SpinLockRelease(&pHeader->nLockWord);
+            status = LIBCB_BUFFEREMPTY;
+            break;
+        }
+
+        CopyFromStorage(self, nHead, aRecordHeader, LIBCB_FILE_RECORD_HEADER_SIZE);
+
+        // only the newest record is verified on open, never run past the tail
+        if (nUsed < LIBCB_FILE_RECORD_HEADER_SIZE || nUsed - LIBCB_FILE_RECORD_HEADER_SIZE < aRecordHeader[0])
+        {
+            SpinLockRelease(&pHeader->nLockWord);
+            status = LIBCB_BUFFERUNDERFLOW;
+            break;
+        }
+
+        if (pnSize != NULL)
+        {
+            *pnSize = aRecordHeader[0];
+        }
+
+        if (aRecordHeader[0] > nDestinationSize)
+        {
+            SpinLockRelease(&pHeader->nLockWord);
+            status = LIBCB_BUFFEROVERFLOW;
+            break;
+        }
+
+        CopyFromStorage(self, nHead + LIBCB_FILE_RECORD_HEADER_SIZE, pDestination, aRecordHeader[0]);
+        pHeader->nHead = nHead + LIBCB_FILE_RECORD_HEADER_SIZE + aRecordHeader[0];
+
+        status = CommitHeader(self, 0, 0);
+
+        SpinLockRelease(&pHeader->nLockWord);
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t circularBufferFileGetCount(CircularBufferFile *self)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (self == NULL || self->pHeader == NULL)
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        SpinLockAcquire(&self->pHeader->nLockWord);
+        status = (int32_t)(self->pHeader->nTail - self->pHeader->nHead);
+        SpinLockRelease(&self->pHeader->nLockWord);
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t FormatFile(CircularBufferFile *self, int nFd, uint32_t nBufferSize, uint32_t nFlags)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (nBufferSize == 0 || nBufferSize > 0x40000000u || self->nPageSize < sizeof(CircularBufferFileHeader))
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        // free-running indexes need a power of two
+        nBufferSize--;
+        nBufferSize |= nBufferSize >> 1;
+        nBufferSize |= nBufferSize >> 2;
+        nBufferSize |= nBufferSize >> 4;
+        nBufferSize |= nBufferSize >> 8;
+        nBufferSize |= nBufferSize >> 16;
+        nBufferSize++;
+
+        // the header owns a whole page so it is written back on its own
+        uint32_t nMapSize = self->nPageSize + nBufferSize;
+
+        if (ftruncate(nFd, nMapSize) != 0)
+        {
+            status = LIBCB_SYSTEMERROR;
+            break;
+        }
+
+        void *pMapping = mmap(NULL, nMapSize, PROT_READ | PROT_WRITE, MAP_SHARED, nFd, 0);
+
+        if (pMapping == MAP_FAILED)
+        {
+            status = LIBCB_SYSTEMERROR;
+            break;
+        }
+
+        // a file left by an earlier attempt may hold part of a header, the
+        // indexes and the lock start out at 0 and the magic is written last
+        memset(pMapping, 0, self->nPageSize);
+
+        self->pHeader = (CircularBufferFileHeader *)pMapping;
+        self->pData = (uint8_t *)pMapping + self->nPageSize;
+        self->nMapSize = nMapSize;
+
+        self->pHeader->nVersion = LIBCB_FILE_VERSION;
+        self->pHeader->nBufferSize = nBufferSize;
+        self->pHeader->nFlags = nFlags;
+        self->pHeader->nDataOffset = self->nPageSize;
+        self->pHeader->nGeneration = 1;
+        self->pHeader->nMagic = LIBCB_FILE_MAGIC;
+
+        status = SyncPages(self, (const uint8_t *)self->pHeader, self->nPageSize, MS_SYNC);
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t RecoverFile(CircularBufferFile *self, int nFd, off_t nFileSize, uint8_t bExclusive)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (nFileSize < (off_t)sizeof(CircularBufferFileHeader) || nFileSize > (off_t)UINT32_MAX)
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        void *pMapping = mmap(NULL, (size_t)nFileSize, PROT_READ | PROT_WRITE, MAP_SHARED, nFd, 0);
+
+        if (pMapping == MAP_FAILED)
+        {
+            status = LIBCB_SYSTEMERROR;
+            break;
+        }
+
+        CircularBufferFileHeader *pHeader = (CircularBufferFileHeader *)pMapping;
+
+        self->pHeader = pHeader;
+        self->nMapSize = (uint32_t)nFileSize;
+
+        if (
+            pHeader->nMagic != LIBCB_FILE_MAGIC || pHeader->nVersion != LIBCB_FILE_VERSION ||
+            pHeader->nFlags > LIBCB_FILE_FLAG_RECORD ||
+            pHeader->nDataOffset < sizeof(CircularBufferFileHeader) || (pHeader->nDataOffset & (self->nPageSize - 1)) != 0 ||
+            pHeader->nBufferSize == 0 || (pHeader->nBufferSize & (pHeader->nBufferSize - 1)) != 0 ||
+            (uint64_t)pHeader->nDataOffset + pHeader->nBufferSize > self->nMapSize ||
+            pHeader->nTail - pHeader->nHead > pHeader->nBufferSize
+            )
+        {
+            munmap(pMapping, self->nMapSize);
+            self->pHeader = NULL;
+            self->nMapSize = 0;
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        self->pData = (uint8_t *)pMapping + pHeader->nDataOffset;
+
+        // with no other handle open, a holder of the lock or a writer of the
+        // newest record did not survive the previous run
+        if (bExclusive)
+        {
+            pHeader->nLockWord = LOCK_UNLOCKED;
+
+            if (pHeader->nFlags & LIBCB_FILE_FLAG_RECORD)
+            {
+                DiscardTornRecord(self);
+            }
+        }
+
+        status = CommitHeader(self, 0, 0);
+
+        break;
+    }
+
+    return status;
+}
+
+void DiscardTornRecord(CircularBufferFile *self)
+{
+    CircularBufferFileHeader *pHeader = self->pHeader;
+    uint32_t nRecordSize = pHeader->nTail - pHeader->nLastRecord;
+    uint32_t aRecordHeader[2];
+
+    // nothing is known about the newest record or it was already consumed
+    if (nRecordSize == 0 || nRecordSize > pHeader->nTail - pHeader->nHead)
+    {
+        return;
+    }
+
+    if (nRecordSize >= LIBCB_FILE_RECORD_HEADER_SIZE)
+    {
+        CopyFromStorage(self, pHeader->nLastRecord, aRecordHeader, LIBCB_FILE_RECORD_HEADER_SIZE);
+
+        if (aRecordHeader[0] == nRecordSize - LIBCB_FILE_RECORD_HEADER_SIZE)
+        {
+            uint32_t nOffset = (pHeader->nLastRecord + LIBCB_FILE_RECORD_HEADER_SIZE) & (pHeader->nBufferSize - 1);
+            uint32_t nFirstSize = pHeader->nBufferSize - nOffset;
+
+            nFirstSize = nFirstSize < aRecordHeader[0] ? nFirstSize : aRecordHeader[0];
+
+            uint32_t nCrc = circularBufferCrc32c(0, self->pData + nOffset, nFirstSize);
+
+            nCrc = circularBufferCrc32c(nCrc, self->pData, aRecordHeader[0] - nFirstSize);
+
+            if (nCrc == aRecordHeader[1])
+            {
+                return;
+            }
+        }
+    }
+
+    // the header reached the disk ahead of the data, the record is torn
+    self->nDiscarded = nRecordSize;
+    pHeader->nTail = pHeader->nLastRecord;
+}
+
+void CopyToStorage(CircularBufferFile *self, uint32_t nIndex, const void *pSource, uint32_t nSize)
+{
+    uint32_t nOffset = nIndex & (self->pHeader->nBufferSize - 1);
+    uint32_t nFirstCopySize = self->pHeader->nBufferSize - nOffset;
+
+    nFirstCopySize = nFirstCopySize < nSize ? nFirstCopySize : nSize;
+
+    memcpy(self->pData + nOffset, pSource, nFirstCopySize);
+    memcpy(self->pData, (const uint8_t *)pSource + nFirstCopySize, nSize - nFirstCopySize);
+}
+
+void CopyFromStorage(CircularBufferFile *self, uint32_t nIndex, void *pDestination, uint32_t nSize)
+{
+    uint32_t nOffset = nIndex & (self->pHeader->nBufferSize - 1);
+    uint32_t nFirstCopySize = self->pHeader->nBufferSize - nOffset;
+
+    nFirstCopySize = nFirstCopySize < nSize ? nFirstCopySize : nSize;
+
+    memcpy(pDestination, self->pData + nOffset, nFirstCopySize);
+    memcpy((uint8_t *)pDestination + nFirstCopySize, self->pData, nSize - nFirstCopySize);
+}
+
+int32_t SyncStorage(CircularBufferFile *self, uint32_t nIndex, uint32_t nSize, int nMode)
+{
+    uint32_t nOffset = nIndex & (self->pHeader->nBufferSize - 1);
+    uint32_t nFirstSize = self->pHeader->nBufferSize - nOffset;
+
+    nFirstSize = nFirstSize < nSize ? nFirstSize : nSize;
+
+    int32_t status = SyncPages(self, self->pData + nOffset, nFirstSize, nMode);
+
+    if (status == LIBCB_SUCCESS && nSize != nFirstSize)
+    {
+        status = SyncPages(self, self->pData, nSize - nFirstSize, nMode);
+    }
+
+    return status;
+}
+
+int32_t SyncPages(CircularBufferFile *self, const uint8_t *pStart, uint32_t nSize, int nMode)
+{
+    uintptr_t nFirst = (uintptr_t)pStart & ~(uintptr_t)(self->nPageSize - 1);
+    uintptr_t nLast = (uintptr_t)pStart + nSize;
+
+    return msync((void *)nFirst, nLast - nFirst, nMode) == 0 ? LIBCB_SUCCESS : LIBCB_SYSTEMERROR;
+}
+
+int32_t CommitHeader(CircularBufferFile *self, uint32_t nIndex, uint32_t nSize)
+{
+    int32_t status = LIBCB_SUCCESS;
+    int nMode = self->nSyncPolicy == LIBCB_FILE_SYNC_ALWAYS ? MS_SYNC : MS_ASYNC;
+
+    // an open that is not exclusive counts without holding the lock
+    __atomic_add_fetch(&self->pHeader->nGeneration, 1, __ATOMIC_RELAXED);
+
+    if (self->nSyncPolicy != LIBCB_FILE_SYNC_NONE)
+    {
+        if (nSize != 0)
+        {
+            status = SyncStorage(self, nIndex, nSize, nMode);
+        }
+
+        if (status == LIBCB_SUCCESS)
+        {
+            status = SyncPages(self, (const uint8_t *)self->pHeader, (uint32_t)sizeof(CircularBufferFileHeader), nMode);
+        }
+    }
+
+    return status;
+}
+
+#else
+
+int32_t circularBufferFileOpen(CircularBufferFile *self, const char *pPath, uint32_t nBufferSize, uint32_t nFlags, uint32_t nSyncPolicy)
+{
+    (void)self;
+    (void)pPath;
+    (void)nBufferSize;
+    (void)nFlags;
+    (void)nSyncPolicy;
+
+    return LIBCB_NOTSUPPORTED;
+}
+
+int32_t circularBufferFileClose(CircularBufferFile *self)
+{
+    (void)self;
+
+    return LIBCB_NOTSUPPORTED;
+}
+
+int32_t circularBufferFileFlush(CircularBufferFile *self)
+{
+    (void)self;
+
+    return LIBCB_NOTSUPPORTED;
+}
+
+int32_t circularBufferFilePush(CircularBufferFile *self, const void *pSource, uint32_t nSourceSize)
+{
+    (void)self;
+    (void)pSource;
+    (void)nSourceSize;
+
+    return LIBCB_NOTSUPPORTED;
+}
+
+int32_t circularBufferFilePop(CircularBufferFile *self, void *pDestination, uint32_t nDestinationSize)
+{
+    (void)self;
+    (void)pDestination;
+    (void)nDestinationSize;
+
+    return LIBCB_NOTSUPPORTED;
+}
+
+int32_t circularBufferFilePushRecord(CircularBufferFile *self, const void *pSource, uint32_t nSourceSize)
+{
+    (void)self;
+    (void)pSource;
+    (void)nSourceSize;
+
+    return LIBCB_NOTSUPPORTED;
+}
+
+int32_t circularBufferFilePopRecord(CircularBufferFile *self, void *pDestination, uint32_t nDestinationSize, uint32_t *pnSize)
+{
+    (void)self;
+    (void)pDestination;
+    (void)nDestinationSize;
+    (void)pnSize;
+
+    return LIBCB_NOTSUPPORTED;
+}
+
+int32_t circularBufferFileGetCount(CircularBufferFile *self)
+{
+    (void)self;
+
+    return LIBCB_NOTSUPPORTED;
+}
+
+#endif
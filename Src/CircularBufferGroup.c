@@ -0,0 +1,326 @@
+#include "libCircularBuffer/CircularBufferGroup.h"
+
+// Take the ring for the consumer in LIBCB_GROUP_FLAG_FIFO mode, FALSE if another consumer holds it
+static uint8_t Claim(CircularBufferGroup *self, uint32_t nConsumer, uint32_t nRing, uint8_t *pbTaken);
+
+// Give a ring back that was claimed for a pop that found nothing
+static void Unclaim(CircularBufferGroup *self, uint32_t nRing, uint8_t bTaken);
+
+int32_t circularBufferGroupInitialize(CircularBufferGroup *self, CircularBufferGroupInit init)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (
+            self == NULL || init.pBuffer == NULL || init.aMembers == NULL || init.nRingCount == 0 ||
+            (init.nFlags & ~LIBCB_GROUP_FLAG_FIFO) != 0
+            )
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        // whole cache lines keep the data of neighbouring rings apart
+        uint32_t nRingSize = (init.nBufferSize / init.nRingCount) & ~(uint32_t)(LIBCB_CACHELINE - 1);
+
+        if (nRingSize <= LIBCB_RECORD_HEADER_SIZE)
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        uint32_t i;
+
+        for (i = 0; i < init.nRingCount; i++)
+        {
+            CircularBufferInit ringInit;
+
+            ringInit.pBuffer = (uint8_t *)init.pBuffer + i * nRingSize;
+            ringInit.nBufferSize = nRingSize;
+            ringInit.pfnMutexInitialize = NULL;
+            ringInit.pfnMutexLock = NULL;
+            ringInit.pfnMutexRelease = NULL;
+
+            status = circularBufferInitializeWithFlags(&init.aMembers[i].ring, ringInit, LIBCB_FLAG_RECORD | LIBCB_FLAG_LOCKTTAS);
+
+            if (status != LIBCB_SUCCESS)
+            {
+                break;
+            }
+
+            __atomic_store_n(&init.aMembers[i].nClaim, 0, __ATOMIC_RELAXED);
+        }
+
+        if (status != LIBCB_SUCCESS)
+        {
+            while (i-- != 0)
+            {
+                circularBufferDeinitialize(&init.aMembers[i].ring);
+            }
+
+            break;
+        }
+
+        self->init = init;
+        self->nRingSize = nRingSize;
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t circularBufferGroupDeinitialize(CircularBufferGroup *self)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (self == NULL || self->init.aMembers == NULL)
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        for (uint32_t i = 0; i < self->init.nRingCount; i++)
+        {
+            circularBufferDeinitialize(&self->init.aMembers[i].ring);
+        }
+
+        self->init.aMembers = NULL;
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t circularBufferGroupPush(CircularBufferGroup *self, uint32_t nProducer, const void *pSource, uint32_t nSourceSize)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (self == NULL || self->init.aMembers == NULL)
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        status = circularBufferPushRecord(&self->init.aMembers[nProducer % self->init.nRingCount].ring, pSource, nSourceSize);
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t circularBufferGroupPop(
+    CircularBufferGroup *self,
+    uint32_t nConsumer,
+    void *pDestination,
+    uint32_t nDestinationSize,
+    uint32_t *pnSize,
+    uint32_t *pnRing
+)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        // the claim stores nConsumer + 1, which must not wrap to the free value
+        if (self == NULL || self->init.aMembers == NULL || nConsumer == UINT32_MAX)
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        uint32_t nHome = nConsumer % self->init.nRingCount;
+
+        status = LIBCB_BUFFEREMPTY;
+
+        for (uint32_t i = 0; i < self->init.nRingCount && status == LIBCB_BUFFEREMPTY; i++)
+        {
+            uint32_t nRing = (nHome + i) % self->init.nRingCount;
+            uint8_t bTaken = FALSE;
+
+            if (!Claim(self, nConsumer, nRing, &bTaken))
+            {
+                continue;
+            }
+
+            status = circularBufferPopRecord(&self->init.aMembers[nRing].ring, pDestination, nDestinationSize, pnSize);
+
+            if (status == LIBCB_SUCCESS || status == LIBCB_CHECKSUMERROR)
+            {
+                if (pnRing != NULL)
+                {
+                    *pnRing = nRing;
+                }
+            }
+            else
+            {
+                Unclaim(self, nRing, bTaken);
+            }
+        }
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t circularBufferGroupPopv(
+    CircularBufferGroup *self,
+    uint32_t nConsumer,
+    CircularBufferSpan *aDestinations,
+    uint32_t nDestinationCount,
+    uint32_t *pnRing
+)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (
+            self == NULL || self->init.aMembers == NULL || aDestinations == NULL || nDestinationCount == 0 ||
+            nConsumer == UINT32_MAX
+            )
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        uint32_t nHome = nConsumer % self->init.nRingCount;
+
+        status = LIBCB_BUFFEREMPTY;
+
+        for (uint32_t i = 0; i < self->init.nRingCount && status == LIBCB_BUFFEREMPTY; i++)
+        {
+            uint32_t nRing = (nHome + i) % self->init.nRingCount;
+            uint8_t bTaken = FALSE;
+
+            if (!Claim(self, nConsumer, nRing, &bTaken))
+            {
+                continue;
+            }
+
+            status = circularBufferPopv(&self->init.aMembers[nRing].ring, aDestinations, nDestinationCount, LIBCB_BATCH_PARTIAL);
+
+            if (status > 0)
+            {
+                if (pnRing != NULL)
+                {
+                    *pnRing = nRing;
+                }
+            }
+            else
+            {
+                Unclaim(self, nRing, bTaken);
+
+                if (status == 0)
+                {
+                    status = LIBCB_BUFFEREMPTY;
+                }
+            }
+        }
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t circularBufferGroupRelease(CircularBufferGroup *self, uint32_t nConsumer, uint32_t nRing)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (
+            self == NULL || self->init.aMembers == NULL || nRing >= self->init.nRingCount ||
+            nConsumer == UINT32_MAX || !(self->init.nFlags & LIBCB_GROUP_FLAG_FIFO)
+            )
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        uint32_t nExpected = nConsumer + 1;
+
+        // the pops of this consumer happen before the next owner pops
+        if (!__atomic_compare_exchange_n(
+                &self->init.aMembers[nRing].nClaim, &nExpected, 0,
+                FALSE, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+        {
+            status = LIBCB_INVALIDPARAM;
+        }
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t circularBufferGroupGetCount(CircularBufferGroup *self)
+{
+    int32_t status = 0;
+
+    for (;;)
+    {
+        if (self == NULL || self->init.aMembers == NULL)
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        for (uint32_t i = 0; i < self->init.nRingCount; i++)
+        {
+            int32_t nCount = circularBufferGetCount(&self->init.aMembers[i].ring);
+
+            if (nCount < 0)
+            {
+                status = nCount;
+                break;
+            }
+
+            status += nCount;
+        }
+
+        break;
+    }
+
+    return status;
+}
+
+uint8_t Claim(CircularBufferGroup *self, uint32_t nConsumer, uint32_t nRing, uint8_t *pbTaken)
+{
+    uint8_t bClaimed = TRUE;
+
+    *pbTaken = FALSE;
+
+    if (self->init.nFlags & LIBCB_GROUP_FLAG_FIFO)
+    {
+        uint32_t nExpected = 0;
+
+        // a ring held by this consumer already is popped again without a new claim
+        if (__atomic_load_n(&self->init.aMembers[nRing].nClaim, __ATOMIC_ACQUIRE) != nConsumer + 1)
+        {
+            bClaimed = __atomic_compare_exchange_n(
+                &self->init.aMembers[nRing].nClaim, &nExpected, nConsumer + 1,
+                FALSE, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+            *pbTaken = bClaimed;
+        }
+    }
+
+    return bClaimed;
+}
+
+void Unclaim(CircularBufferGroup *self, uint32_t nRing, uint8_t bTaken)
+{
+    if (bTaken)
+    {
+        __atomic_store_n(&self->init.aMembers[nRing].nClaim, 0, __ATOMIC_RELEASE);
+    }
+}
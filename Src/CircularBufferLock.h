@@ -0,0 +1,124 @@
+#ifndef INCLUDED_LIBCIRCULARBUFFERLOCK_H
+#define INCLUDED_LIBCIRCULARBUFFERLOCK_H
+
+#include "CircularBufferPrivate.h"
+
+// Longest pause sequence of the spinning policies between two attempts
+#define LOCK_BACKOFF_MAX        1024u
+
+// Attempts of the adaptive lock before it parks on the futex
+#define LOCK_ADAPTIVE_SPINS     100u
+
+// States of the adaptive lock word
+#define LOCK_UNLOCKED           0u
+#define LOCK_LOCKED             1u
+#define LOCK_CONTENDED          2u
+
+/// @brief this function tells the core the caller is spinning
+static inline void CpuRelax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+/// @brief this function takes a ticket and spins until it is served, waiters
+///        back off in proportion to their distance from the head of the queue
+/// @param pNext next ticket to hand out
+/// @param pServing ticket currently holding the lock
+static inline void TicketLockAcquire(uint32_t *pNext, uint32_t *pServing)
+{
+    uint32_t nTicket = __atomic_fetch_add(pNext, 1, __ATOMIC_RELAXED);
+    uint32_t nServing;
+
+    while ((nServing = __atomic_load_n(pServing, __ATOMIC_ACQUIRE)) != nTicket)
+    {
+        for (uint32_t i = (nTicket - nServing) * 16u; i != 0; i--)
+        {
+            CpuRelax();
+        }
+    }
+}
+
+/// @brief this function hands the ticket lock to the next waiter
+/// @param pServing ticket currently holding the lock
+static inline void TicketLockRelease(uint32_t *pServing)
+{
+    // only the holder writes the word, a plain increment is enough
+    __atomic_store_n(pServing, __atomic_load_n(pServing, __ATOMIC_RELAXED) + 1, __ATOMIC_RELEASE);
+}
+
+/// @brief this function acquires a test-and-test-and-set spinlock, the word is
+///        only written once it was seen free and the pause doubles after every miss
+/// @param pWord lock word, 0 when free
+static inline void SpinLockAcquire(uint32_t *pWord)
+{
+    uint32_t nBackoff = 1;
+
+    while (
+        __atomic_load_n(pWord, __ATOMIC_RELAXED) != LOCK_UNLOCKED ||
+        __atomic_exchange_n(pWord, LOCK_LOCKED, __ATOMIC_ACQUIRE) != LOCK_UNLOCKED
+        )
+    {
+        for (uint32_t i = 0; i < nBackoff; i++)
+        {
+            CpuRelax();
+        }
+
+        nBackoff = nBackoff < LOCK_BACKOFF_MAX ? nBackoff * 2 : LOCK_BACKOFF_MAX;
+    }
+}
+
+/// @brief this function releases a test-and-test-and-set spinlock
+/// @param pWord lock word
+static inline void SpinLockRelease(uint32_t *pWord)
+{
+    __atomic_store_n(pWord, LOCK_UNLOCKED, __ATOMIC_RELEASE);
+}
+
+/// @brief this function spins for a short while and then parks on the futex,
+///        the word records whether anybody parked so an uncontended release
+///        never enters the kernel
+/// @param pWord lock word, LOCK_UNLOCKED when free
+static inline void AdaptiveLockAcquire(uint32_t *pWord)
+{
+    uint32_t nExpected;
+
+    for (uint32_t i = 0; i < LOCK_ADAPTIVE_SPINS; i++)
+    {
+        nExpected = LOCK_UNLOCKED;
+
+        if (
+            __atomic_load_n(pWord, __ATOMIC_RELAXED) == LOCK_UNLOCKED &&
+            __atomic_compare_exchange_n(pWord, &nExpected, LOCK_LOCKED, FALSE, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)
+            )
+        {
+            return;
+        }
+
+        CpuRelax();
+    }
+
+    // from here on the lock is taken as contended so the release wakes a waiter
+    while (__atomic_exchange_n(pWord, LOCK_CONTENDED, __ATOMIC_ACQUIRE) != LOCK_UNLOCKED)
+    {
+        if (circularBufferFutexWait(pWord, LOCK_CONTENDED, UINT64_MAX) == LIBCB_NOTSUPPORTED)
+        {
+            CpuRelax();
+        }
+    }
+}
+
+/// @brief this function releases the adaptive lock and wakes one parked waiter
+/// @param pWord lock word
+static inline void AdaptiveLockRelease(uint32_t *pWord)
+{
+    if (__atomic_exchange_n(pWord, LOCK_UNLOCKED, __ATOMIC_RELEASE) == LOCK_CONTENDED)
+    {
+        circularBufferFutexWake(pWord, 1);
+    }
+}
+
+#endif // INCLUDED_LIBCIRCULARBUFFERLOCK_H
@@ -0,0 +1,120 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "CircularBufferPrivate.h"
+
+#if defined(__linux__)
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+int32_t circularBufferMirrorAllocate(uint32_t *pnSize, void **ppBuffer)
+{
+    int32_t status = LIBCB_SUCCESS;
+    int fd = -1;
+    uint8_t *pRegion = MAP_FAILED;
+
+    for (;;)
+    {
+        if (pnSize == NULL || ppBuffer == NULL || *pnSize == 0)
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        uint64_t nPageSize = (uint64_t)sysconf(_SC_PAGESIZE);
+        uint64_t nSize = (*pnSize + nPageSize - 1) / nPageSize * nPageSize;
+
+        // both copies together still have to be addressable with 32 bit offsets
+        if (nSize > 0x80000000u)
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        fd = memfd_create("libCircularBuffer", MFD_CLOEXEC);
+
+        if (fd < 0 || ftruncate(fd, (off_t)nSize) != 0)
+        {
+            status = LIBCB_SYSTEMERROR;
+            break;
+        }
+
+        // reserve the address range first so nobody else can map into the gap
+        pRegion = mmap(NULL, nSize * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (pRegion == MAP_FAILED)
+        {
+            status = LIBCB_SYSTEMERROR;
+            break;
+        }
+
+        if (
+            mmap(pRegion, nSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+            mmap(pRegion + nSize, nSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED
+            )
+        {
+            munmap(pRegion, nSize * 2);
+            status = LIBCB_SYSTEMERROR;
+            break;
+        }
+
+        *pnSize = (uint32_t)nSize;
+        *ppBuffer = pRegion;
+
+        break;
+    }
+
+    // the mappings keep the pages alive
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+
+    return status;
+}
+
+int32_t circularBufferMirrorFree(void *pBuffer, uint32_t nSize)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (pBuffer == NULL || nSize == 0)
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        if (munmap(pBuffer, (size_t)nSize * 2) != 0)
+        {
+            status = LIBCB_SYSTEMERROR;
+            break;
+        }
+
+        break;
+    }
+
+    return status;
+}
+
+#else
+
+int32_t circularBufferMirrorAllocate(uint32_t *pnSize, void **ppBuffer)
+{
+    (void)pnSize;
+    (void)ppBuffer;
+
+    return LIBCB_NOTSUPPORTED;
+}
+
+int32_t circularBufferMirrorFree(void *pBuffer, uint32_t nSize)
+{
+    (void)pBuffer;
+    (void)nSize;
+
+    return LIBCB_NOTSUPPORTED;
+}
+
+#endif
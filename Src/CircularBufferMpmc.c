@@ -0,0 +1,260 @@
+#include <string.h>
+#include "libCircularBuffer/CircularBufferMpmc.h"
+
+// Header stored in front of every slot
+typedef struct
+{
+    uint32_t nSequence; // Position the slot is ready for
+    uint32_t nSize;     // Number of bytes stored in the slot
+} MpmcSlot;
+
+// Get the slot that serves the given position
+static MpmcSlot *GetSlot(CircularBufferMpmc *self, uint32_t nPosition);
+
+int32_t circularBufferMpmcInitialize(CircularBufferMpmc *self, CircularBufferMpmcInit init)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (
+            self == NULL || init.pBuffer == NULL ||
+            init.nElementSize == 0 || init.nElementSize > init.nBufferSize ||
+            // the slot header and the alignment must not wrap the slot size
+            init.nElementSize > UINT32_MAX - sizeof(MpmcSlot) - 7u ||
+            ((uintptr_t)init.pBuffer % sizeof(uint64_t)) != 0
+            )
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        // keep every slot header naturally aligned
+        uint32_t nSlotSize = (sizeof(MpmcSlot) + init.nElementSize + 7u) & ~7u;
+        uint32_t nSlotCount = init.nBufferSize / nSlotSize;
+
+        if (nSlotCount < 2)
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        // round down to a power of two so positions can wrap freely
+        while (nSlotCount & (nSlotCount - 1))
+        {
+            nSlotCount &= nSlotCount - 1;
+        }
+
+        memset(self, 0, sizeof(*self));
+
+        self->init = init;
+        self->nSlotSize = nSlotSize;
+        self->nSlotMask = nSlotCount - 1;
+
+        for (uint32_t i = 0; i < nSlotCount; i++)
+        {
+            MpmcSlot *pSlot = GetSlot(self, i);
+
+            pSlot->nSequence = i;
+            pSlot->nSize = 0;
+        }
+
+        __atomic_store_n(&self->nEnqueuePos, 0, __ATOMIC_RELEASE);
+        __atomic_store_n(&self->nDequeuePos, 0, __ATOMIC_RELEASE);
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t circularBufferMpmcPush(CircularBufferMpmc *self, const void *pSource, uint32_t nSourceSize)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (self == NULL || pSource == NULL || nSourceSize == 0)
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        if (nSourceSize > self->init.nElementSize)
+        {
+            status = LIBCB_BUFFEROVERFLOW;
+            break;
+        }
+
+        MpmcSlot *pSlot = NULL;
+        uint32_t nPosition = __atomic_load_n(&self->nEnqueuePos, __ATOMIC_RELAXED);
+
+        for (;;)
+        {
+            pSlot = GetSlot(self, nPosition);
+
+            uint32_t nSequence = __atomic_load_n(&pSlot->nSequence, __ATOMIC_ACQUIRE);
+            int32_t nDifference = (int32_t)(nSequence - nPosition);
+
+            if (nDifference == 0)
+            {
+                // the slot is free for this lap, try to claim the position
+                if (__atomic_compare_exchange_n(
+                        &self->nEnqueuePos, &nPosition, nPosition + 1,
+                        TRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                {
+                    break;
+                }
+            }
+            else if (nDifference < 0)
+            {
+                // the slot still holds the element of the previous lap
+                pSlot = NULL;
+                break;
+            }
+            else
+            {
+                nPosition = __atomic_load_n(&self->nEnqueuePos, __ATOMIC_RELAXED);
+            }
+        }
+
+        if (pSlot == NULL)
+        {
+            status = LIBCB_BUFFEROVERFLOW;
+            break;
+        }
+
+        memcpy(pSlot + 1, pSource, nSourceSize);
+        pSlot->nSize = nSourceSize;
+
+        __atomic_store_n(&pSlot->nSequence, nPosition + 1, __ATOMIC_RELEASE);
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t circularBufferMpmcPop(CircularBufferMpmc *self, void *pDestination, uint32_t nDestinationSize, uint32_t *pnSize)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (self == NULL || pDestination == NULL || nDestinationSize < self->init.nElementSize)
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        MpmcSlot *pSlot = NULL;
+        uint32_t nPosition = __atomic_load_n(&self->nDequeuePos, __ATOMIC_RELAXED);
+
+        for (;;)
+        {
+            pSlot = GetSlot(self, nPosition);
+
+            uint32_t nSequence = __atomic_load_n(&pSlot->nSequence, __ATOMIC_ACQUIRE);
+            int32_t nDifference = (int32_t)(nSequence - (nPosition + 1));
+
+            if (nDifference == 0)
+            {
+                // the slot is published for this lap, try to claim the position
+                if (__atomic_compare_exchange_n(
+                        &self->nDequeuePos, &nPosition, nPosition + 1,
+                        TRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                {
+                    break;
+                }
+            }
+            else if (nDifference < 0)
+            {
+                // the producer of this position has not published yet
+                pSlot = NULL;
+                break;
+            }
+            else
+            {
+                nPosition = __atomic_load_n(&self->nDequeuePos, __ATOMIC_RELAXED);
+            }
+        }
+
+        if (pSlot == NULL)
+        {
+            status = LIBCB_BUFFEREMPTY;
+            break;
+        }
+
+        memcpy(pDestination, pSlot + 1, pSlot->nSize);
+
+        if (pnSize != NULL)
+        {
+            *pnSize = pSlot->nSize;
+        }
+
+        // hand the slot over to the producer of the next lap
+        __atomic_store_n(&pSlot->nSequence, nPosition + self->nSlotMask + 1, __ATOMIC_RELEASE);
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t circularBufferMpmcGetCapacity(CircularBufferMpmc *self)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (self == NULL)
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        status = (int32_t)(self->nSlotMask + 1);
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t circularBufferMpmcGetCount(CircularBufferMpmc *self)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (self == NULL)
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        uint32_t nDequeue = __atomic_load_n(&self->nDequeuePos, __ATOMIC_ACQUIRE);
+        uint32_t nEnqueue = __atomic_load_n(&self->nEnqueuePos, __ATOMIC_ACQUIRE);
+        int32_t nCount = (int32_t)(nEnqueue - nDequeue);
+
+        if (nCount < 0)
+        {
+            nCount = 0;
+        }
+        else if ((uint32_t)nCount > self->nSlotMask + 1)
+        {
+            nCount = (int32_t)(self->nSlotMask + 1);
+        }
+
+        status = nCount;
+
+        break;
+    }
+
+    return status;
+}
+
+MpmcSlot *GetSlot(CircularBufferMpmc *self, uint32_t nPosition)
+{
+    return (MpmcSlot *)((uint8_t *)self->init.pBuffer + (nPosition & self->nSlotMask) * self->nSlotSize);
+}
@@ -0,0 +1,80 @@
+#ifndef INCLUDED_LIBCIRCULARBUFFERPRIVATE_H
+#define INCLUDED_LIBCIRCULARBUFFERPRIVATE_H
+
+#include "libCircularBuffer/CircularBufferExt.h"
+
+/// @brief this function maps the same pages twice back-to-back so that any
+///        region of up to nSize bytes starting inside the first copy is contiguous
+/// @param pnSize requested size, rounded up to the page size on return
+/// @param ppBuffer receives the start of the first copy
+/// @return LIBCB_NOTSUPPORTED on platforms without memfd_create
+int32_t circularBufferMirrorAllocate(uint32_t *pnSize, void **ppBuffer);
+
+/// @brief this function releases a mapping created by circularBufferMirrorAllocate
+/// @param pBuffer start of the first copy
+/// @param nSize size returned by circularBufferMirrorAllocate
+/// @return
+int32_t circularBufferMirrorFree(void *pBuffer, uint32_t nSize);
+
+/// @brief this function reads the monotonic clock
+/// @return CLOCK_MONOTONIC time in nanoseconds, 0 where it is not available
+uint64_t circularBufferMonotonicTime(void);
+
+/// @brief this function converts a relative timeout into a monotonic deadline
+/// @param nTimeoutMs timeout in milliseconds or LIBCB_WAIT_FOREVER
+/// @return deadline in nanoseconds, UINT64_MAX for no deadline
+uint64_t circularBufferWaitDeadline(uint32_t nTimeoutMs);
+
+/// @brief this function parks the caller while the word still holds nExpected
+/// @param pWord futex word
+/// @param nExpected value the caller observed
+/// @param nDeadline deadline returned by circularBufferWaitDeadline
+/// @return LIBCB_SUCCESS on a wakeup or a changed word, LIBCB_TIMEOUT past the deadline
+int32_t circularBufferFutexWait(uint32_t *pWord, uint32_t nExpected, uint64_t nDeadline);
+
+/// @brief this function wakes threads parked on the word
+/// @param pWord futex word
+/// @param nCount maximum number of threads to wake, UINT32_MAX for all
+void circularBufferFutexWake(uint32_t *pWord, uint32_t nCount);
+
+/// @brief this function creates a non-blocking eventfd
+/// @param nInitial initial counter value
+/// @param pnFd receives the file descriptor
+/// @return LIBCB_NOTSUPPORTED on platforms without eventfd
+int32_t circularBufferEventOpen(uint32_t nInitial, int32_t *pnFd);
+
+/// @brief this function adds one to the counter of the eventfd
+/// @param nFd file descriptor created by circularBufferEventOpen
+void circularBufferEventSignal(int32_t nFd);
+
+/// @brief this function closes an eventfd, negative descriptors are ignored
+/// @param nFd file descriptor created by circularBufferEventOpen
+void circularBufferEventClose(int32_t nFd);
+
+/// @brief this type is a copy kernel, it returns once every store is ordered
+///        before any later release store
+typedef void (*CircularBufferCopyFn)(void *pDestination, const void *pSource, uint32_t nSize);
+
+/// @brief this function resolves a LIBCB_FLAG_COPY* kernel for the running CPU
+/// @param nCopy flags holding one of the LIBCB_FLAG_COPY* values
+/// @param ppfnCopy receives the kernel
+/// @return LIBCB_NOTSUPPORTED if the CPU lacks the instructions of the kernel
+int32_t circularBufferCopySelect(uint32_t nCopy, CircularBufferCopyFn *ppfnCopy);
+
+/// @brief this function resolves the kernel that copies out of the buffer, the
+///        streaming kernels keep the cache there because the caller usually
+///        reads its destination right after the pop
+/// @param nCopy flags holding one of the LIBCB_FLAG_COPY* values
+/// @param ppfnCopy receives the kernel
+/// @return LIBCB_NOTSUPPORTED if the CPU lacks the instructions of the kernel
+int32_t circularBufferCopySelectOut(uint32_t nCopy, CircularBufferCopyFn *ppfnCopy);
+
+/// @brief this function copies the data and continues its CRC32C in one pass
+/// @param nCrc CRC of the preceding data, 0 to start
+/// @param pDestination pointer to the destination
+/// @param pSource pointer to the data
+/// @param nSize number of bytes
+/// @return CRC including the data
+uint32_t circularBufferCrc32cCopy(uint32_t nCrc, void *pDestination, const void *pSource, uint32_t nSize);
+
+#endif // INCLUDED_LIBCIRCULARBUFFERPRIVATE_H
@@ -0,0 +1,483 @@
+#include <string.h>
+#include "libCircularBuffer/CircularBufferShm.h"
+#include "CircularBufferLock.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Map the shared memory object and fill in the view
+static int32_t MapObject(CircularBufferShm *self, int nFd, uint32_t nMapSize);
+
+// Copy into the storage starting at the index, wrapping if needed
+static void CopyToStorage(CircularBufferShm *self, uint32_t nIndex, const void *pSource, uint32_t nSize);
+
+// Copy out of the storage starting at the index, wrapping if needed
+static void CopyFromStorage(CircularBufferShm *self, uint32_t nIndex, void *pDestination, uint32_t nSize);
+
+int32_t circularBufferShmCreate(CircularBufferShm *self, const char *pName, uint32_t nBufferSize, uint32_t nFlags)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (
+            self == NULL || pName == NULL || nBufferSize == 0 || nBufferSize > 0x80000000u ||
+            nFlags > LIBCB_SHM_FLAG_SPSC
+            )
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        // free-running indexes need a power of two
+        nBufferSize--;
+        nBufferSize |= nBufferSize >> 1;
+        nBufferSize |= nBufferSize >> 2;
+        nBufferSize |= nBufferSize >> 4;
+        nBufferSize |= nBufferSize >> 8;
+        nBufferSize |= nBufferSize >> 16;
+        nBufferSize++;
+
+        int nFd = shm_open(pName, O_RDWR | O_CREAT | O_EXCL, 0600);
+
+        if (nFd < 0)
+        {
+            status = LIBCB_SYSTEMERROR;
+            break;
+        }
+
+        uint32_t nMapSize = (uint32_t)sizeof(CircularBufferShmHeader) + nBufferSize;
+
+        if (ftruncate(nFd, nMapSize) != 0)
+        {
+            int nError = errno;
+
+            close(nFd);
+            shm_unlink(pName);
+            errno = nError;
+            status = LIBCB_SYSTEMERROR;
+            break;
+        }
+
+        status = MapObject(self, nFd, nMapSize);
+
+        if (status != LIBCB_SUCCESS)
+        {
+            shm_unlink(pName);
+            break;
+        }
+
+        // a new object is zero filled, the indexes and the lock start out at 0
+        self->pHeader->nVersion = LIBCB_SHM_VERSION;
+        self->pHeader->nBufferSize = nBufferSize;
+        self->pHeader->nFlags = nFlags;
+        self->pHeader->nDataOffset = (uint32_t)sizeof(CircularBufferShmHeader);
+        self->pData = (uint8_t *)self->pHeader + self->pHeader->nDataOffset;
+        self->nBufferSize = nBufferSize;
+        self->nFlags = nFlags;
+
+        // attaching processes only trust the fields above once the magic is visible
+        __atomic_store_n(&self->pHeader->nMagic, LIBCB_SHM_MAGIC, __ATOMIC_RELEASE);
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t circularBufferShmAttach(CircularBufferShm *self, const char *pName)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (self == NULL || pName == NULL)
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        int nFd = shm_open(pName, O_RDWR, 0);
+        struct stat info;
+
+        if (nFd < 0)
+        {
+            status = LIBCB_SYSTEMERROR;
+            break;
+        }
+
+        if (fstat(nFd, &info) != 0 || info.st_size < (off_t)sizeof(CircularBufferShmHeader) || info.st_size > (off_t)UINT32_MAX)
+        {
+            close(nFd);
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        status = MapObject(self, nFd, (uint32_t)info.st_size);
+
+        if (status != LIBCB_SUCCESS)
+        {
+            break;
+        }
+
+        CircularBufferShmHeader *pHeader = self->pHeader;
+
+        if (__atomic_load_n(&pHeader->nMagic, __ATOMIC_ACQUIRE) != LIBCB_SHM_MAGIC)
+        {
+            circularBufferShmDetach(self);
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        // each field is read once, only the copies that passed are used later
+        uint32_t nVersion = __atomic_load_n(&pHeader->nVersion, __ATOMIC_RELAXED);
+        uint32_t nBufferSize = __atomic_load_n(&pHeader->nBufferSize, __ATOMIC_RELAXED);
+        uint32_t nFlags = __atomic_load_n(&pHeader->nFlags, __ATOMIC_RELAXED);
+        uint32_t nDataOffset = __atomic_load_n(&pHeader->nDataOffset, __ATOMIC_RELAXED);
+
+        if (
+            nVersion != LIBCB_SHM_VERSION || nFlags > LIBCB_SHM_FLAG_SPSC ||
+            nDataOffset < sizeof(CircularBufferShmHeader) ||
+            nBufferSize == 0 || (nBufferSize & (nBufferSize - 1)) != 0 ||
+            (uint64_t)nDataOffset + nBufferSize > self->nMapSize
+            )
+        {
+            circularBufferShmDetach(self);
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        self->pData = (uint8_t *)pHeader + nDataOffset;
+        self->nBufferSize = nBufferSize;
+        self->nFlags = nFlags;
+
+        // a ring that already carried traffic has moved on from 0
+        self->nCachedHead = __atomic_load_n(&pHeader->nHead, __ATOMIC_ACQUIRE);
+        self->nCachedTail = __atomic_load_n(&pHeader->nTail, __ATOMIC_ACQUIRE);
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t circularBufferShmDetach(CircularBufferShm *self)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (self == NULL || self->pHeader == NULL)
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        if (munmap(self->pHeader, self->nMapSize) != 0)
+        {
+            status = LIBCB_SYSTEMERROR;
+        }
+
+        self->pHeader = NULL;
+        self->pData = NULL;
+        self->nMapSize = 0;
+        self->nBufferSize = 0;
+        self->nFlags = 0;
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t circularBufferShmUnlink(const char *pName)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (pName == NULL)
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        if (shm_unlink(pName) != 0)
+        {
+            status = LIBCB_SYSTEMERROR;
+        }
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t circularBufferShmPush(CircularBufferShm *self, const void *pSource, uint32_t nSourceSize)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (self == NULL || self->pHeader == NULL || pSource == NULL || nSourceSize == 0)
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        CircularBufferShmHeader *pHeader = self->pHeader;
+
+        if (self->nBufferSize < nSourceSize)
+        {
+            status = LIBCB_BUFFEROVERFLOW;
+            break;
+        }
+
+        if (self->nFlags & LIBCB_SHM_FLAG_SPSC)
+        {
+            uint32_t nTail = __atomic_load_n(&pHeader->nTail, __ATOMIC_RELAXED);
+
+            // the cached head lives in this process and is never ahead of the real one
+            if (self->nBufferSize - (nTail - self->nCachedHead) < nSourceSize)
+            {
+                self->nCachedHead = __atomic_load_n(&pHeader->nHead, __ATOMIC_ACQUIRE);
+
+                if (self->nBufferSize - (nTail - self->nCachedHead) < nSourceSize)
+                {
+                    status = LIBCB_BUFFEROVERFLOW;
+                    break;
+                }
+            }
+
+            CopyToStorage(self, nTail, pSource, nSourceSize);
+            __atomic_store_n(&pHeader->nTail, nTail + nSourceSize, __ATOMIC_RELEASE);
+            break;
+        }
+
+        SpinLockAcquire(&pHeader->nLockWord);
+
+        if (self->nBufferSize - (pHeader->nTail - pHeader->nHead) < nSourceSize)
+        {
+            SpinLockRelease(&pHeader->nLockWord);
+            status = LIBCB_BUFFEROVERFLOW;
+            break;
+        }
+
+        CopyToStorage(self, pHeader->nTail, pSource, nSourceSize);
+        pHeader->nTail += nSourceSize;
+
+        SpinLockRelease(&pHeader->nLockWord);
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t circularBufferShmPop(CircularBufferShm *self, void *pDestination, uint32_t nDestinationSize)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (self == NULL || self->pHeader == NULL || pDestination == NULL || nDestinationSize == 0)
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        CircularBufferShmHeader *pHeader = self->pHeader;
+        uint32_t nUsed;
+
+        // the storage never holds more, whatever indexes a peer left behind
+        if (self->nBufferSize < nDestinationSize)
+        {
+            status = LIBCB_BUFFERUNDERFLOW;
+            break;
+        }
+
+        if (self->nFlags & LIBCB_SHM_FLAG_SPSC)
+        {
+            uint32_t nHead = __atomic_load_n(&pHeader->nHead, __ATOMIC_RELAXED);
+
+            nUsed = self->nCachedTail - nHead;
+
+            if (nUsed < nDestinationSize)
+            {
+                self->nCachedTail = __atomic_load_n(&pHeader->nTail, __ATOMIC_ACQUIRE);
+                nUsed = self->nCachedTail - nHead;
+            }
+
+            if (nUsed < nDestinationSize)
+            {
+                status = nUsed == 0 ? LIBCB_BUFFEREMPTY : LIBCB_BUFFERUNDERFLOW;
+                break;
+            }
+
+            CopyFromStorage(self, nHead, pDestination, nDestinationSize);
+            __atomic_store_n(&pHeader->nHead, nHead + nDestinationSize, __ATOMIC_RELEASE);
+            break;
+        }
+
+        SpinLockAcquire(&pHeader->nLockWord);
+
+        nUsed = pHeader->nTail - pHeader->nHead;
+
+        if (nUsed < nDestinationSize)
+        {
+            SpinLockRelease(&pHeader->nLockWord);
+            status = nUsed == 0 ? LIBCB_BUFFEREMPTY : LIBCB_BUFFERUNDERFLOW;
+            break;
+        }
+
+        CopyFromStorage(self, pHeader->nHead, pDestination, nDestinationSize);
+        pHeader->nHead += nDestinationSize;
+
+        SpinLockRelease(&pHeader->nLockWord);
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t circularBufferShmGetCount(CircularBufferShm *self)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        if (self == NULL || self->pHeader == NULL)
+        {
+            status = LIBCB_INVALIDPARAM;
+            break;
+        }
+
+        uint32_t nHead = __atomic_load_n(&self->pHeader->nHead, __ATOMIC_ACQUIRE);
+        uint32_t nTail = __atomic_load_n(&self->pHeader->nTail, __ATOMIC_ACQUIRE);
+        uint32_t nUsed = nTail - nHead;
+
+        // the indexes are sampled one after the other, never report past capacity
+        status = (int32_t)(nUsed <= self->nBufferSize ? nUsed : self->nBufferSize);
+
+        break;
+    }
+
+    return status;
+}
+
+int32_t MapObject(CircularBufferShm *self, int nFd, uint32_t nMapSize)
+{
+    int32_t status = LIBCB_SUCCESS;
+    void *pMapping = mmap(NULL, nMapSize, PROT_READ | PROT_WRITE, MAP_SHARED, nFd, 0);
+    int nError = errno;
+
+    // the mapping keeps the object alive, the descriptor is not needed anymore
+    close(nFd);
+
+    if (pMapping == MAP_FAILED)
+    {
+        errno = nError;
+        status = LIBCB_SYSTEMERROR;
+    }
+    else
+    {
+        self->pHeader = (CircularBufferShmHeader *)pMapping;
+        self->pData = NULL;
+        self->nMapSize = nMapSize;
+        self->nBufferSize = 0;
+        self->nFlags = 0;
+        self->nCachedHead = 0;
+        self->nCachedTail = 0;
+    }
+
+    return status;
+}
+
+void CopyToStorage(CircularBufferShm *self, uint32_t nIndex, const void *pSource, uint32_t nSize)
+{
+    uint32_t nOffset = nIndex & (self->nBufferSize - 1);
+    uint32_t nFirstCopySize = self->nBufferSize - nOffset;
+
+    nFirstCopySize = nFirstCopySize < nSize ? nFirstCopySize : nSize;
+
+    memcpy(self->pData + nOffset, pSource, nFirstCopySize);
+    memcpy(self->pData, (const uint8_t *)pSource + nFirstCopySize, nSize - nFirstCopySize);
+}
+
+void CopyFromStorage(CircularBufferShm *self, uint32_t nIndex, void *pDestination, uint32_t nSize)
+{
+    uint32_t nOffset = nIndex & (self->nBufferSize - 1);
+    uint32_t nFirstCopySize = self->nBufferSize - nOffset;
+
+    nFirstCopySize = nFirstCopySize < nSize ? nFirstCopySize : nSize;
+
+    memcpy(pDestination, self->pData + nOffset, nFirstCopySize);
+    memcpy((uint8_t *)pDestination + nFirstCopySize, self->pData, nSize - nFirstCopySize);
+}
+
+#else
+
+int32_t circularBufferShmCreate(CircularBufferShm *self, const char *pName, uint32_t nBufferSize, uint32_t nFlags)
+{
+    (void)self;
+    (void)pName;
+    (void)nBufferSize;
+    (void)nFlags;
+
+    return LIBCB_NOTSUPPORTED;
+}
+
+int32_t circularBufferShmAttach(CircularBufferShm *self, const char *pName)
+{
+    (void)self;
+    (void)pName;
+
+    return LIBCB_NOTSUPPORTED;
+}
+
+int32_t circularBufferShmDetach(CircularBufferShm *self)
+{
+    (void)self;
+
+    return LIBCB_NOTSUPPORTED;
+}
+
+int32_t circularBufferShmUnlink(const char *pName)
+{
+    (void)pName;
+
+    return LIBCB_NOTSUPPORTED;
+}
+
+int32_t circularBufferShmPush(CircularBufferShm *self, const void *pSource, uint32_t nSourceSize)
+{
+    (void)self;
+    (void)pSource;
+    (void)nSourceSize;
+
+    return LIBCB_NOTSUPPORTED;
+}
+
+int32_t circularBufferShmPop(CircularBufferShm *self, void *pDestination, uint32_t nDestinationSize)
+{
+    (void)self;
+    (void)pDestination;
+    (void)nDestinationSize;
+
+    return LIBCB_NOTSUPPORTED;
+}
+
+int32_t circularBufferShmGetCount(CircularBufferShm *self)
+{
+    (void)self;
+
+    return LIBCB_NOTSUPPORTED;
+}
+
+#endif
@@ -0,0 +1,153 @@
+#include "CircularBufferPrivate.h"
+
+#if defined(__linux__)
+
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+
+uint64_t circularBufferWaitDeadline(uint32_t nTimeoutMs)
+{
+    if (nTimeoutMs == LIBCB_WAIT_FOREVER)
+    {
+        return UINT64_MAX;
+    }
+
+    return circularBufferMonotonicTime() + (uint64_t)nTimeoutMs * 1000000u;
+}
+
+int32_t circularBufferFutexWait(uint32_t *pWord, uint32_t nExpected, uint64_t nDeadline)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    for (;;)
+    {
+        struct timespec timeout;
+        struct timespec *pTimeout = NULL;
+
+        if (nDeadline != UINT64_MAX)
+        {
+            uint64_t nNow = circularBufferMonotonicTime();
+
+            if (nNow >= nDeadline)
+            {
+                status = LIBCB_TIMEOUT;
+                break;
+            }
+
+            timeout.tv_sec = (time_t)((nDeadline - nNow) / 1000000000u);
+            timeout.tv_nsec = (long)((nDeadline - nNow) % 1000000000u);
+            pTimeout = &timeout;
+        }
+
+        // EAGAIN (word already moved) and EINTR both send the caller back to retry
+        if (syscall(SYS_futex, pWord, FUTEX_WAIT_PRIVATE, nExpected, pTimeout, NULL, 0) != 0 && errno == ETIMEDOUT)
+        {
+            status = LIBCB_TIMEOUT;
+        }
+
+        break;
+    }
+
+    return status;
+}
+
+void circularBufferFutexWake(uint32_t *pWord, uint32_t nCount)
+{
+    syscall(SYS_futex, pWord, FUTEX_WAKE_PRIVATE, nCount < INT_MAX ? (int)nCount : INT_MAX, NULL, NULL, 0);
+}
+
+int32_t circularBufferEventOpen(uint32_t nInitial, int32_t *pnFd)
+{
+    int32_t status = LIBCB_SUCCESS;
+
+    *pnFd = eventfd(nInitial, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if (*pnFd < 0)
+    {
+        status = LIBCB_SYSTEMERROR;
+    }
+
+    return status;
+}
+
+void circularBufferEventSignal(int32_t nFd)
+{
+    uint64_t nOne = 1;
+
+    // a full counter (EAGAIN) is still readable, nothing is lost
+    while (write(nFd, &nOne, sizeof(nOne)) < 0 && errno == EINTR)
+    {
+    }
+}
+
+void circularBufferEventClose(int32_t nFd)
+{
+    if (nFd >= 0)
+    {
+        close(nFd);
+    }
+}
+
+uint64_t circularBufferMonotonicTime(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+#else
+
+uint64_t circularBufferMonotonicTime(void)
+{
+    return 0;
+}
+
+uint64_t circularBufferWaitDeadline(uint32_t nTimeoutMs)
+{
+    (void)nTimeoutMs;
+
+    return UINT64_MAX;
+}
+
+int32_t circularBufferFutexWait(uint32_t *pWord, uint32_t nExpected, uint64_t nDeadline)
+{
+    (void)pWord;
+    (void)nExpected;
+    (void)nDeadline;
+
+    return LIBCB_NOTSUPPORTED;
+}
+
+void circularBufferFutexWake(uint32_t *pWord, uint32_t nCount)
+{
+    (void)pWord;
+    (void)nCount;
+}
+
+int32_t circularBufferEventOpen(uint32_t nInitial, int32_t *pnFd)
+{
+    (void)nInitial;
+
+    *pnFd = -1;
+
+    return LIBCB_NOTSUPPORTED;
+}
+
+void circularBufferEventSignal(int32_t nFd)
+{
+    (void)nFd;
+}
+
+void circularBufferEventClose(int32_t nFd)
+{
+    (void)nFd;
+}
+
+#endif
@@ -0,0 +1,810 @@
+#include <pthread.h>
+#include <sched.h>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "benchmark/benchmark.h"
+#include "libCircularBuffer/CircularBuffer.hpp"
+#include "libCircularBuffer/CircularBufferExt.h"
+#include "libCircularBuffer/CircularBufferGroup.h"
+#include "libCircularBuffer/CircularBufferMpmc.h"
+
+static int32_t mutexInitialize(uint32_t **pMutex)
+{
+    pthread_mutex_t *pthreadMutex = new pthread_mutex_t;
+
+    pthread_mutex_init(pthreadMutex, NULL);
+    *pMutex = reinterpret_cast<uint32_t *>(pthreadMutex);
+
+    return LIBCB_SUCCESS;
+}
+
+static int32_t mutexLock(uint32_t *pMutex)
+{
+    return pthread_mutex_lock(reinterpret_cast<pthread_mutex_t *>(pMutex));
+}
+
+static int32_t mutexRelease(uint32_t *pMutex)
+{
+    return pthread_mutex_unlock(reinterpret_cast<pthread_mutex_t *>(pMutex));
+}
+
+static void mutexDestroy(uint32_t *pMutex)
+{
+    pthread_mutex_t *pthreadMutex = reinterpret_cast<pthread_mutex_t *>(pMutex);
+
+    pthread_mutex_destroy(pthreadMutex);
+    delete pthreadMutex;
+}
+
+static CircularBuffer ring;
+static std::vector<uint8_t> ringStorage;
+
+// thread 0 pushes and thread 1 pops the same number of messages, retrying
+// while the ring is full or empty, so both sides always finish together
+static void BM_OneProducerOneConsumer(benchmark::State &state, uint32_t nFlags, bool useMutex)
+{
+    uint32_t messageSize = static_cast<uint32_t>(state.range(0));
+    std::vector<uint8_t> message(messageSize);
+
+    if (state.thread_index() == 0)
+    {
+        CircularBufferInit cbInit;
+
+        ringStorage.assign(64 * 1024, 0);
+
+        cbInit.pBuffer = ringStorage.data();
+        cbInit.nBufferSize = static_cast<uint32_t>(ringStorage.size());
+        cbInit.pfnMutexInitialize = useMutex ? mutexInitialize : NULL;
+        cbInit.pfnMutexLock = useMutex ? mutexLock : NULL;
+        cbInit.pfnMutexRelease = useMutex ? mutexRelease : NULL;
+
+        circularBufferInitializeWithFlags(&ring, cbInit, nFlags);
+    }
+
+    for (auto _ : state)
+    {
+        if (state.thread_index() == 0)
+        {
+            while (circularBufferPush(&ring, message.data(), messageSize) != LIBCB_SUCCESS)
+            {
+                std::this_thread::yield();
+            }
+        }
+        else
+        {
+            while (circularBufferPop(&ring, message.data(), messageSize) != LIBCB_SUCCESS)
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * messageSize);
+
+    if (state.thread_index() == 0 && ring.pMutex != NULL)
+    {
+        mutexDestroy(ring.pMutex);
+        ring.pMutex = NULL;
+    }
+}
+
+BENCHMARK_CAPTURE(BM_OneProducerOneConsumer, Mutex, LIBCB_FLAG_NONE, true)
+    ->Arg(8)->Arg(64)->Arg(1024)->Threads(2)->UseRealTime();
+BENCHMARK_CAPTURE(BM_OneProducerOneConsumer, Spsc, LIBCB_FLAG_SPSC, false)
+    ->Arg(8)->Arg(64)->Arg(1024)->Threads(2)->UseRealTime();
+
+static CircularBufferMpmc mpmcRing;
+static std::vector<uint64_t> mpmcStorage;
+
+// even threads push and odd threads pop, every thread runs the same number
+// of iterations so producers and consumers move the same number of elements
+static void BM_MpmcContention(benchmark::State &state)
+{
+    uint64_t element[2] = { 0, 0 };
+
+    if (state.thread_index() == 0)
+    {
+        CircularBufferMpmcInit cbInit;
+
+        mpmcStorage.assign(8 * 1024, 0);
+
+        cbInit.pBuffer = mpmcStorage.data();
+        cbInit.nBufferSize = static_cast<uint32_t>(mpmcStorage.size() * sizeof(uint64_t));
+        cbInit.nElementSize = sizeof(element);
+
+        circularBufferMpmcInitialize(&mpmcRing, cbInit);
+    }
+
+    for (auto _ : state)
+    {
+        if (state.thread_index() % 2 == 0)
+        {
+            while (circularBufferMpmcPush(&mpmcRing, element, sizeof(element)) != LIBCB_SUCCESS)
+            {
+                std::this_thread::yield();
+            }
+        }
+        else
+        {
+            while (circularBufferMpmcPop(&mpmcRing, element, sizeof(element), NULL) != LIBCB_SUCCESS)
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+// same topology through the mutex protected byte ring for comparison
+static void BM_MutexContention(benchmark::State &state)
+{
+    uint64_t element[2] = { 0, 0 };
+
+    if (state.thread_index() == 0)
+    {
+        CircularBufferInit cbInit;
+
+        ringStorage.assign(64 * 1024, 0);
+
+        cbInit.pBuffer = ringStorage.data();
+        cbInit.nBufferSize = static_cast<uint32_t>(ringStorage.size());
+        cbInit.pfnMutexInitialize = mutexInitialize;
+        cbInit.pfnMutexLock = mutexLock;
+        cbInit.pfnMutexRelease = mutexRelease;
+
+        circularBufferInitialize(&ring, cbInit);
+    }
+
+    for (auto _ : state)
+    {
+        if (state.thread_index() % 2 == 0)
+        {
+            while (circularBufferPush(&ring, element, sizeof(element)) != LIBCB_SUCCESS)
+            {
+                std::this_thread::yield();
+            }
+        }
+        else
+        {
+            while (circularBufferPop(&ring, element, sizeof(element)) != LIBCB_SUCCESS)
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index() == 0)
+    {
+        mutexDestroy(ring.pMutex);
+        ring.pMutex = NULL;
+    }
+}
+
+BENCHMARK(BM_MpmcContention)->ThreadRange(2, 16)->UseRealTime();
+BENCHMARK(BM_MutexContention)->ThreadRange(2, 16)->UseRealTime();
+
+// 32 messages of 16 bytes through the mutex path, one call per message
+// against one call per batch
+static void BM_MutexBatch(benchmark::State &state, bool batched)
+{
+    CircularBufferInit cbInit;
+    uint8_t messages[32][16] = {};
+    CircularBufferSpan spans[32];
+
+    ringStorage.assign(4 * 1024, 0);
+
+    cbInit.pBuffer = ringStorage.data();
+    cbInit.nBufferSize = static_cast<uint32_t>(ringStorage.size());
+    cbInit.pfnMutexInitialize = mutexInitialize;
+    cbInit.pfnMutexLock = mutexLock;
+    cbInit.pfnMutexRelease = mutexRelease;
+
+    circularBufferInitialize(&ring, cbInit);
+
+    for (uint32_t i = 0; i < 32; i++)
+    {
+        spans[i].pData = messages[i];
+        spans[i].nSize = sizeof(messages[i]);
+    }
+
+    for (auto _ : state)
+    {
+        if (batched)
+        {
+            circularBufferPushv(&ring, spans, 32, LIBCB_BATCH_ALLORNOTHING);
+            circularBufferPopv(&ring, spans, 32, LIBCB_BATCH_ALLORNOTHING);
+        }
+        else
+        {
+            for (uint32_t i = 0; i < 32; i++)
+            {
+                circularBufferPush(&ring, messages[i], sizeof(messages[i]));
+            }
+
+            for (uint32_t i = 0; i < 32; i++)
+            {
+                circularBufferPop(&ring, messages[i], sizeof(messages[i]));
+            }
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * 32);
+
+    mutexDestroy(ring.pMutex);
+    ring.pMutex = NULL;
+}
+
+BENCHMARK_CAPTURE(BM_MutexBatch, PerMessage, false);
+BENCHMARK_CAPTURE(BM_MutexBatch, Batched, true);
+
+// single threaded push/pop through the generic index arithmetic against the
+// masked free-running indexes, the ring size is a power of two in both cases
+static void BM_IndexArithmetic(benchmark::State &state, uint32_t nFlags)
+{
+    CircularBufferInit cbInit;
+    uint8_t message[24] = {};
+
+    ringStorage.assign(4 * 1024, 0);
+
+    cbInit.pBuffer = ringStorage.data();
+    cbInit.nBufferSize = static_cast<uint32_t>(ringStorage.size());
+    cbInit.pfnMutexInitialize = NULL;
+    cbInit.pfnMutexLock = NULL;
+    cbInit.pfnMutexRelease = NULL;
+
+    circularBufferInitializeWithFlags(&ring, cbInit, nFlags);
+
+    for (auto _ : state)
+    {
+        circularBufferPush(&ring, message, sizeof(message));
+        circularBufferPop(&ring, message, sizeof(message));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_CAPTURE(BM_IndexArithmetic, Generic, LIBCB_FLAG_NONE);
+BENCHMARK_CAPTURE(BM_IndexArithmetic, PowerOfTwo, LIBCB_FLAG_POWEROFTWO);
+BENCHMARK_CAPTURE(BM_IndexArithmetic, SpscGeneric, LIBCB_FLAG_SPSC);
+BENCHMARK_CAPTURE(BM_IndexArithmetic, SpscPowerOfTwo, LIBCB_FLAG_SPSC | LIBCB_FLAG_POWEROFTWO);
+
+// the same single threaded push/pop of 24 byte elements through the typed
+// C++ ring, the capacity matches the 4 KiB rings above
+struct Message
+{
+    uint8_t aData[24];
+};
+
+template <uint32_t N>
+static void BM_CppRing(benchmark::State &state)
+{
+    static libcb::Ring<Message, N> cppRing;
+    Message message = {};
+
+    for (auto _ : state)
+    {
+        cppRing.push(message);
+        cppRing.pop(message);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_TEMPLATE(BM_CppRing, 170);
+BENCHMARK_TEMPLATE(BM_CppRing, 128);
+
+// minimal lock-free index pair that replicates the control block layouts, the
+// packed one keeps every index on one cache line like the struct used to
+struct PackedIndexes
+{
+    uint32_t nHead;
+    uint32_t nTail;
+    uint32_t nCachedHead;
+    uint32_t nCachedTail;
+};
+
+struct PaddedIndexes
+{
+    alignas(LIBCB_CACHELINE) uint32_t nTail;
+    uint32_t nCachedHead;
+    alignas(LIBCB_CACHELINE) uint32_t nHead;
+    uint32_t nCachedTail;
+};
+
+static const uint32_t replicaSlots = 1024;
+static uint64_t replicaStorage[replicaSlots];
+
+template <typename Layout, bool cached>
+static bool replicaPush(Layout &indexes, uint64_t value)
+{
+    uint32_t nTail = __atomic_load_n(&indexes.nTail, __ATOMIC_RELAXED);
+
+    if (!cached || nTail - indexes.nCachedHead == replicaSlots)
+    {
+        indexes.nCachedHead = __atomic_load_n(&indexes.nHead, __ATOMIC_ACQUIRE);
+
+        if (nTail - indexes.nCachedHead == replicaSlots)
+        {
+            return false;
+        }
+    }
+
+    replicaStorage[nTail % replicaSlots] = value;
+    __atomic_store_n(&indexes.nTail, nTail + 1, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+template <typename Layout, bool cached>
+static bool replicaPop(Layout &indexes, uint64_t &value)
+{
+    uint32_t nHead = __atomic_load_n(&indexes.nHead, __ATOMIC_RELAXED);
+
+    if (!cached || nHead == indexes.nCachedTail)
+    {
+        indexes.nCachedTail = __atomic_load_n(&indexes.nTail, __ATOMIC_ACQUIRE);
+
+        if (nHead == indexes.nCachedTail)
+        {
+            return false;
+        }
+    }
+
+    value = replicaStorage[nHead % replicaSlots];
+    __atomic_store_n(&indexes.nHead, nHead + 1, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+template <typename Layout, bool cached>
+static void BM_ControlBlockLayout(benchmark::State &state)
+{
+    static Layout indexes;
+    uint64_t value = 0;
+
+    if (state.thread_index() == 0)
+    {
+        indexes = Layout();
+    }
+
+    for (auto _ : state)
+    {
+        if (state.thread_index() == 0)
+        {
+            while (!replicaPush<Layout, cached>(indexes, value))
+            {
+                std::this_thread::yield();
+            }
+        }
+        else
+        {
+            while (!replicaPop<Layout, cached>(indexes, value))
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_TEMPLATE(BM_ControlBlockLayout, PackedIndexes, false)->Threads(2)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ControlBlockLayout, PaddedIndexes, false)->Threads(2)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ControlBlockLayout, PaddedIndexes, true)->Threads(2)->UseRealTime();
+
+// one producer and one consumer of 16 byte messages through every lock policy,
+// the pthread mutex goes through the callbacks
+static void BM_LockPolicy(benchmark::State &state, uint32_t nFlags, bool useMutex)
+{
+    uint8_t message[16] = {};
+
+    if (state.thread_index() == 0)
+    {
+        CircularBufferInit cbInit;
+
+        ringStorage.assign(4 * 1024, 0);
+
+        cbInit.pBuffer = ringStorage.data();
+        cbInit.nBufferSize = static_cast<uint32_t>(ringStorage.size());
+        cbInit.pfnMutexInitialize = useMutex ? mutexInitialize : NULL;
+        cbInit.pfnMutexLock = useMutex ? mutexLock : NULL;
+        cbInit.pfnMutexRelease = useMutex ? mutexRelease : NULL;
+
+        circularBufferInitializeWithFlags(&ring, cbInit, nFlags);
+    }
+
+    for (auto _ : state)
+    {
+        if (state.thread_index() == 0)
+        {
+            while (circularBufferPush(&ring, message, sizeof(message)) != LIBCB_SUCCESS)
+            {
+                std::this_thread::yield();
+            }
+        }
+        else
+        {
+            while (circularBufferPop(&ring, message, sizeof(message)) != LIBCB_SUCCESS)
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index() == 0 && ring.pMutex != NULL)
+    {
+        mutexDestroy(ring.pMutex);
+        ring.pMutex = NULL;
+    }
+}
+
+BENCHMARK_CAPTURE(BM_LockPolicy, PthreadMutex, LIBCB_FLAG_LOCKCALLBACK, true)->Threads(2)->UseRealTime();
+BENCHMARK_CAPTURE(BM_LockPolicy, Ticket, LIBCB_FLAG_LOCKTICKET, false)->Threads(2)->UseRealTime();
+BENCHMARK_CAPTURE(BM_LockPolicy, Ttas, LIBCB_FLAG_LOCKTTAS, false)->Threads(2)->UseRealTime();
+BENCHMARK_CAPTURE(BM_LockPolicy, Adaptive, LIBCB_FLAG_LOCKADAPTIVE, false)->Threads(2)->UseRealTime();
+
+// payload sizes of the size sweeps, 1 B to 64 KiB
+#define SWEEP_SIZES RangeMultiplier(4)->Range(1, 64 << 10)
+
+// cores the threaded sweeps are pinned to, taken from the comma separated
+// LIBCB_BENCH_CPUS, thread i runs on the i-th entry modulo the list length
+static std::vector<int> pinnedCpus()
+{
+    static std::vector<int> cpus;
+
+    if (cpus.empty())
+    {
+        const char *list = std::getenv("LIBCB_BENCH_CPUS");
+        std::stringstream stream(list != NULL ? list : "");
+        std::string item;
+
+        while (std::getline(stream, item, ','))
+        {
+            cpus.push_back(std::atoi(item.c_str()));
+        }
+
+        for (int cpu = 0; cpus.empty() && cpu < (int)std::thread::hardware_concurrency(); cpu++)
+        {
+            cpus.push_back(cpu);
+        }
+    }
+
+    return cpus;
+}
+
+// pins the calling benchmark thread and returns its previous affinity, thread 0
+// is the main thread of the runner and has to be restored afterwards
+static cpu_set_t pinThread(int threadIndex)
+{
+    cpu_set_t previous, pinned;
+    std::vector<int> cpus = pinnedCpus();
+
+    CPU_ZERO(&previous);
+    pthread_getaffinity_np(pthread_self(), sizeof(previous), &previous);
+
+    if (!cpus.empty())
+    {
+        CPU_ZERO(&pinned);
+        CPU_SET(cpus[threadIndex % cpus.size()], &pinned);
+        pthread_setaffinity_np(pthread_self(), sizeof(pinned), &pinned);
+    }
+
+    return previous;
+}
+
+// sizes the ring for one payload, a ring of exactly the payload size never
+// splits a copy while one extra byte makes nearly every copy wrap around the end
+static void initializeSweepRing(uint32_t payloadSize, bool wrap, bool useMutex)
+{
+    CircularBufferInit cbInit;
+
+    ringStorage.assign(payloadSize + (wrap ? 1 : 0), 0);
+
+    cbInit.pBuffer = ringStorage.data();
+    cbInit.nBufferSize = static_cast<uint32_t>(ringStorage.size());
+    cbInit.pfnMutexInitialize = useMutex ? mutexInitialize : NULL;
+    cbInit.pfnMutexLock = useMutex ? mutexLock : NULL;
+    cbInit.pfnMutexRelease = useMutex ? mutexRelease : NULL;
+
+    circularBufferInitialize(&ring, cbInit);
+}
+
+static void releaseSweepRing()
+{
+    if (ring.pMutex != NULL)
+    {
+        mutexDestroy(ring.pMutex);
+        ring.pMutex = NULL;
+    }
+}
+
+// single threaded push and pop of one payload per iteration
+static void BM_PushPopSize(benchmark::State &state, bool useMutex, bool wrap)
+{
+    uint32_t payloadSize = static_cast<uint32_t>(state.range(0));
+    std::vector<uint8_t> payload(payloadSize);
+
+    initializeSweepRing(payloadSize, wrap, useMutex);
+
+    for (auto _ : state)
+    {
+        circularBufferPush(&ring, payload.data(), payloadSize);
+        circularBufferPop(&ring, payload.data(), payloadSize);
+    }
+
+    state.SetBytesProcessed(state.iterations() * payloadSize);
+
+    releaseSweepRing();
+}
+
+BENCHMARK_CAPTURE(BM_PushPopSize, NoMutex/Aligned, false, false)->SWEEP_SIZES;
+BENCHMARK_CAPTURE(BM_PushPopSize, NoMutex/Wrapped, false, true)->SWEEP_SIZES;
+BENCHMARK_CAPTURE(BM_PushPopSize, PthreadMutex/Aligned, true, false)->SWEEP_SIZES;
+BENCHMARK_CAPTURE(BM_PushPopSize, PthreadMutex/Wrapped, true, true)->SWEEP_SIZES;
+
+// single threaded non-destructive read of a full ring, in the wrapped case the
+// content starts one byte in so every read is split at the end of the storage
+static void BM_ReadSize(benchmark::State &state, bool useMutex, bool wrap)
+{
+    uint32_t payloadSize = static_cast<uint32_t>(state.range(0));
+    std::vector<uint8_t> payload(payloadSize);
+
+    initializeSweepRing(payloadSize, wrap, useMutex);
+
+    if (wrap)
+    {
+        circularBufferPush(&ring, payload.data(), 1);
+        circularBufferPop(&ring, payload.data(), 1);
+    }
+
+    circularBufferPush(&ring, payload.data(), payloadSize);
+
+    for (auto _ : state)
+    {
+        circularBufferRead(&ring, payload.data(), payloadSize, 0, payloadSize);
+    }
+
+    state.SetBytesProcessed(state.iterations() * payloadSize);
+
+    releaseSweepRing();
+}
+
+BENCHMARK_CAPTURE(BM_ReadSize, NoMutex/Aligned, false, false)->SWEEP_SIZES;
+BENCHMARK_CAPTURE(BM_ReadSize, NoMutex/Wrapped, false, true)->SWEEP_SIZES;
+BENCHMARK_CAPTURE(BM_ReadSize, PthreadMutex/Aligned, true, false)->SWEEP_SIZES;
+BENCHMARK_CAPTURE(BM_ReadSize, PthreadMutex/Wrapped, true, true)->SWEEP_SIZES;
+
+// single threaded delimiter search over a full wrapped ring whose only match is
+// the last byte, in place against copying out first and scanning the copy
+static void BM_FindDelimiter(benchmark::State &state, bool inPlace)
+{
+    uint32_t payloadSize = static_cast<uint32_t>(state.range(0));
+    std::vector<uint8_t> payload(payloadSize, 'x');
+
+    initializeSweepRing(payloadSize, true, false);
+
+    circularBufferPush(&ring, payload.data(), 1);
+    circularBufferPop(&ring, payload.data(), 1);
+
+    payload[payloadSize - 1] = '\n';
+
+    circularBufferPush(&ring, payload.data(), payloadSize);
+
+    for (auto _ : state)
+    {
+        if (inPlace)
+        {
+            benchmark::DoNotOptimize(circularBufferFind(&ring, '\n', 0));
+        }
+        else
+        {
+            circularBufferRead(&ring, payload.data(), payloadSize, 0, payloadSize);
+            benchmark::DoNotOptimize(memchr(payload.data(), '\n', payloadSize));
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * payloadSize);
+
+    releaseSweepRing();
+}
+
+BENCHMARK_CAPTURE(BM_FindDelimiter, InPlace, true)->SWEEP_SIZES;
+BENCHMARK_CAPTURE(BM_FindDelimiter, ReadThenScan, false)->SWEEP_SIZES;
+
+// even threads push and odd threads pop one payload per iteration through a
+// 256 KiB ring, every thread is pinned so 2 threads are 1P1C and 4 or 8 are NPNC
+static void BM_PinnedTopology(benchmark::State &state, bool useMutex)
+{
+    uint32_t payloadSize = static_cast<uint32_t>(state.range(0));
+    std::vector<uint8_t> payload(payloadSize);
+    cpu_set_t previous = pinThread(state.thread_index());
+
+    if (state.thread_index() == 0)
+    {
+        CircularBufferInit cbInit;
+
+        ringStorage.assign(256 * 1024, 0);
+
+        cbInit.pBuffer = ringStorage.data();
+        cbInit.nBufferSize = static_cast<uint32_t>(ringStorage.size());
+        cbInit.pfnMutexInitialize = useMutex ? mutexInitialize : NULL;
+        cbInit.pfnMutexLock = useMutex ? mutexLock : NULL;
+        cbInit.pfnMutexRelease = useMutex ? mutexRelease : NULL;
+
+        circularBufferInitializeWithFlags(&ring, cbInit, useMutex ? LIBCB_FLAG_NONE : LIBCB_FLAG_LOCKTTAS);
+    }
+
+    for (auto _ : state)
+    {
+        if (state.thread_index() % 2 == 0)
+        {
+            while (circularBufferPush(&ring, payload.data(), payloadSize) != LIBCB_SUCCESS)
+            {
+                std::this_thread::yield();
+            }
+        }
+        else
+        {
+            while (circularBufferPop(&ring, payload.data(), payloadSize) != LIBCB_SUCCESS)
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * payloadSize);
+
+    if (state.thread_index() == 0)
+    {
+        releaseSweepRing();
+    }
+
+    pthread_setaffinity_np(pthread_self(), sizeof(previous), &previous);
+}
+
+BENCHMARK_CAPTURE(BM_PinnedTopology, Spinlock, false)
+    ->Arg(16)->Arg(1024)->Arg(64 << 10)->ThreadRange(2, 8)->UseRealTime();
+BENCHMARK_CAPTURE(BM_PinnedTopology, PthreadMutex, true)
+    ->Arg(16)->Arg(1024)->Arg(64 << 10)->ThreadRange(2, 8)->UseRealTime();
+
+// single threaded push and pop of one large payload per iteration through one
+// copy kernel, streaming stores only pay off once the payload outgrows the cache
+static void BM_CopyKernel(benchmark::State &state, uint32_t nCopy)
+{
+    uint32_t payloadSize = static_cast<uint32_t>(state.range(0));
+    std::vector<uint8_t> payload(payloadSize);
+
+    initializeSweepRing(payloadSize, false, false);
+
+    if (circularBufferPushCopy(&ring, payload.data(), payloadSize, nCopy) == LIBCB_NOTSUPPORTED)
+    {
+        state.SkipWithError("copy kernel not supported by this CPU");
+    }
+    else
+    {
+        circularBufferPopCopy(&ring, payload.data(), payloadSize, nCopy);
+    }
+
+    for (auto _ : state)
+    {
+        circularBufferPushCopy(&ring, payload.data(), payloadSize, nCopy);
+        circularBufferPopCopy(&ring, payload.data(), payloadSize, nCopy);
+    }
+
+    state.SetBytesProcessed(state.iterations() * payloadSize);
+
+    releaseSweepRing();
+}
+
+BENCHMARK_CAPTURE(BM_CopyKernel, Memcpy, LIBCB_FLAG_COPYMEMCPY)->RangeMultiplier(4)->Range(1 << 10, 16 << 20);
+BENCHMARK_CAPTURE(BM_CopyKernel, Avx2, LIBCB_FLAG_COPYAVX2)->RangeMultiplier(4)->Range(1 << 10, 16 << 20);
+BENCHMARK_CAPTURE(BM_CopyKernel, Avx512, LIBCB_FLAG_COPYAVX512)->RangeMultiplier(4)->Range(1 << 10, 16 << 20);
+BENCHMARK_CAPTURE(BM_CopyKernel, Stream, LIBCB_FLAG_COPYSTREAM)->RangeMultiplier(4)->Range(1 << 10, 16 << 20);
+BENCHMARK_CAPTURE(BM_CopyKernel, Auto, LIBCB_FLAG_COPYAUTO)->RangeMultiplier(4)->Range(1 << 10, 16 << 20);
+
+// single threaded push and pop of one checksummed payload per iteration, the
+// fused mode checksums while copying, the other one makes a second pass
+static void BM_PushCrc(benchmark::State &state, bool fused)
+{
+    uint32_t payloadSize = static_cast<uint32_t>(state.range(0));
+    std::vector<uint8_t> payload(payloadSize, 0x5A);
+    CircularBufferInit cbInit;
+    uint32_t crc = 0;
+
+    ringStorage.assign(payloadSize, 0);
+
+    cbInit.pBuffer = ringStorage.data();
+    cbInit.nBufferSize = payloadSize;
+    cbInit.pfnMutexInitialize = NULL;
+    cbInit.pfnMutexLock = NULL;
+    cbInit.pfnMutexRelease = NULL;
+
+    circularBufferInitializeWithFlags(&ring, cbInit, fused ? LIBCB_FLAG_CRC : LIBCB_FLAG_NONE);
+
+    for (auto _ : state)
+    {
+        circularBufferPush(&ring, payload.data(), payloadSize);
+
+        if (fused)
+        {
+            circularBufferGetPushedCrc(&ring, &crc, TRUE);
+        }
+        else
+        {
+            crc = circularBufferCrc32c(0, payload.data(), payloadSize);
+        }
+
+        benchmark::DoNotOptimize(crc);
+        circularBufferPop(&ring, payload.data(), payloadSize);
+    }
+
+    state.SetBytesProcessed(state.iterations() * payloadSize);
+}
+
+BENCHMARK_CAPTURE(BM_PushCrc, SecondPass, false)->SWEEP_SIZES;
+BENCHMARK_CAPTURE(BM_PushCrc, Fused, true)->SWEEP_SIZES;
+
+static CircularBufferGroup group;
+static std::vector<CircularBufferGroupMember> groupMembers;
+
+// even threads produce and odd threads consume 64 byte records through a group,
+// one ring shared by everybody against one ring per producer with stealing
+static void BM_GroupIngest(benchmark::State &state, bool sharded)
+{
+    uint8_t record[64] = {};
+    uint32_t index = static_cast<uint32_t>(state.thread_index()) / 2;
+
+    if (state.thread_index() == 0)
+    {
+        CircularBufferGroupInit groupInit;
+        uint32_t ringCount = sharded ? static_cast<uint32_t>(state.threads()) / 2 : 1;
+
+        ringStorage.assign(256 * 1024, 0);
+        groupMembers.resize(ringCount);
+
+        groupInit.pBuffer = ringStorage.data();
+        groupInit.nBufferSize = static_cast<uint32_t>(ringStorage.size());
+        groupInit.aMembers = groupMembers.data();
+        groupInit.nRingCount = ringCount;
+        groupInit.nFlags = LIBCB_GROUP_FLAG_NONE;
+
+        circularBufferGroupInitialize(&group, groupInit);
+    }
+
+    for (auto _ : state)
+    {
+        if (state.thread_index() % 2 == 0)
+        {
+            while (circularBufferGroupPush(&group, index, record, sizeof(record)) != LIBCB_SUCCESS)
+            {
+                std::this_thread::yield();
+            }
+        }
+        else
+        {
+            while (circularBufferGroupPop(&group, index, record, sizeof(record), NULL, NULL) != LIBCB_SUCCESS)
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index() == 0)
+    {
+        circularBufferGroupDeinitialize(&group);
+    }
+}
+
+BENCHMARK_CAPTURE(BM_GroupIngest, SharedRing, false)->ThreadRange(2, 16)->UseRealTime();
+BENCHMARK_CAPTURE(BM_GroupIngest, PerProducerRings, true)->ThreadRange(2, 16)->UseRealTime();
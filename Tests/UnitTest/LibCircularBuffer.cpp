@@ -1,6 +1,28 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <sys/resource.h>
 #include "gtest/gtest.h"
 #include "libCircularBuffer/CircularBuffer.h"
 
+// count the mappings of the memfd behind mirrored buffers
+static uint32_t countMirrorMappings()
+{
+    std::ifstream maps("/proc/self/maps");
+    std::string line;
+    uint32_t count = 0;
+
+    while (std::getline(maps, line))
+    {
+        count += line.find("memfd:libCircularBuffer") != std::string::npos;
+    }
+
+    return count;
+}
+
 TEST(CircularBuffer, TestInitialize)
 {
     // create an circular buffer and check if the initialization is correct
@@ -350,4 +372,492 @@ TEST(CircularBuffer, TestPopEmptyBuffer)
     EXPECT_EQ(cb.nCount, 0);
     EXPECT_EQ(cb.nHead, 0);
     EXPECT_EQ(cb.nTail, 0);
-}
\ No newline at end of file
+}
+
+TEST(CircularBuffer, TestSpscWrapAround)
+{
+    // create a lock-free circular buffer and push/pop across the end of the buffer
+    // the count is derived from the indexes and a full buffer is not mistaken as empty
+
+    int32_t status;
+    uint8_t buffer[10], dataToPush[7], dataToCompare[7];
+    uint32_t bufferSize = 10;
+    CircularBufferInit cbInit;
+    CircularBuffer cb;
+
+    cbInit.pBuffer = buffer;
+    cbInit.nBufferSize = bufferSize;
+    cbInit.pfnMutexInitialize = NULL;
+    cbInit.pfnMutexLock = NULL;
+    cbInit.pfnMutexRelease = NULL;
+
+    status = circularBufferInitializeWithFlags(&cb, cbInit, LIBCB_FLAG_SPSC);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+
+    for (uint32_t round = 0; round < 10; round++)
+    {
+        for (uint32_t i = 0; i < sizeof(dataToPush); i++)
+        {
+            dataToPush[i] = (uint8_t)(round * 7 + i);
+        }
+
+        status = circularBufferPush(&cb, dataToPush, sizeof(dataToPush));
+
+        EXPECT_EQ(status, LIBCB_SUCCESS);
+        EXPECT_EQ(circularBufferGetCount(&cb), 7);
+
+        status = circularBufferPush(&cb, dataToPush, 4);
+
+        EXPECT_EQ(status, LIBCB_BUFFEROVERFLOW);
+
+        status = circularBufferPop(&cb, dataToCompare, sizeof(dataToCompare));
+
+        EXPECT_EQ(status, LIBCB_SUCCESS);
+        EXPECT_EQ(memcmp(dataToCompare, dataToPush, sizeof(dataToPush)), 0);
+        EXPECT_EQ(circularBufferIsEmpty(&cb), TRUE);
+    }
+
+    status = circularBufferPush(&cb, buffer, bufferSize);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferIsFull(&cb), TRUE);
+    EXPECT_EQ(circularBufferGetCount(&cb), (int32_t)bufferSize);
+}
+
+TEST(CircularBuffer, TestSpscStress)
+{
+    // create a lock-free circular buffer and run a producer and a consumer thread
+    // the consumer should observe every pushed byte in order
+
+    int32_t status;
+    uint8_t buffer[61];
+    uint32_t bufferSize = 61, totalBytes = 1u << 20;
+    CircularBufferInit cbInit;
+    CircularBuffer cb;
+
+    cbInit.pBuffer = buffer;
+    cbInit.nBufferSize = bufferSize;
+    cbInit.pfnMutexInitialize = NULL;
+    cbInit.pfnMutexLock = NULL;
+    cbInit.pfnMutexRelease = NULL;
+
+    status = circularBufferInitializeWithFlags(&cb, cbInit, LIBCB_FLAG_SPSC);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+
+    std::thread producer([&cb, totalBytes]() {
+        uint8_t chunk[13];
+        uint32_t sent = 0;
+
+        while (sent < totalBytes)
+        {
+            uint32_t size = std::min<uint32_t>(1 + sent % sizeof(chunk), totalBytes - sent);
+
+            for (uint32_t i = 0; i < size; i++)
+            {
+                chunk[i] = (uint8_t)(sent + i);
+            }
+
+            if (circularBufferPush(&cb, chunk, size) == LIBCB_SUCCESS)
+            {
+                sent += size;
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint8_t chunk[5];
+    uint32_t received = 0, mismatches = 0;
+
+    while (received < totalBytes)
+    {
+        uint32_t size = std::min<uint32_t>(1 + received % sizeof(chunk), totalBytes - received);
+
+        if (circularBufferPop(&cb, chunk, size) != LIBCB_SUCCESS)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        for (uint32_t i = 0; i < size; i++)
+        {
+            mismatches += chunk[i] != (uint8_t)(received + i);
+        }
+
+        received += size;
+    }
+
+    producer.join();
+
+    EXPECT_EQ(mismatches, 0u);
+    EXPECT_EQ(circularBufferIsEmpty(&cb), TRUE);
+}
+
+TEST(CircularBuffer, TestMirroredWrapAround)
+{
+    // create a mirrored circular buffer, the size should be rounded up to a page
+    // a push across the end should be visible through both mappings and pop back in order
+
+    int32_t status;
+    uint8_t dataToPush[200], dataToCompare[200];
+    CircularBufferInit cbInit;
+    CircularBuffer cb;
+
+    cbInit.pBuffer = NULL;
+    cbInit.nBufferSize = 100;
+    cbInit.pfnMutexInitialize = NULL;
+    cbInit.pfnMutexLock = NULL;
+    cbInit.pfnMutexRelease = NULL;
+
+    status = circularBufferInitializeWithFlags(&cb, cbInit, LIBCB_FLAG_MIRRORED);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+    ASSERT_NE(cb.init.pBuffer, nullptr);
+
+    uint32_t capacity = (uint32_t)circularBufferGetCapacity(&cb);
+
+    EXPECT_GE(capacity, 100u);
+    EXPECT_EQ(capacity % 4096, 0u);
+
+    cb.nHead = cb.nTail = capacity - 100;
+
+    for (uint32_t i = 0; i < sizeof(dataToPush); i++)
+    {
+        dataToPush[i] = (uint8_t)i;
+    }
+
+    status = circularBufferPush(&cb, dataToPush, sizeof(dataToPush));
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+    EXPECT_EQ(cb.nTail, 100u);
+
+    uint8_t *mapping = (uint8_t *)cb.init.pBuffer;
+
+    EXPECT_EQ(memcmp(mapping + capacity - 100, dataToPush, sizeof(dataToPush)), 0);
+    EXPECT_EQ(memcmp(mapping, dataToPush + 100, 100), 0);
+
+    status = circularBufferPop(&cb, dataToCompare, sizeof(dataToCompare));
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+    EXPECT_EQ(memcmp(dataToCompare, dataToPush, sizeof(dataToPush)), 0);
+
+    status = circularBufferDeinitialize(&cb);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+
+    // a rejected combination of modes leaves no mapping behind
+    uint32_t mappings = countMirrorMappings();
+
+    cbInit.pBuffer = NULL;
+
+    EXPECT_EQ(circularBufferInitializeWithFlags(&cb, cbInit, LIBCB_FLAG_MIRRORED | LIBCB_FLAG_OVERWRITE | LIBCB_FLAG_SPSC), LIBCB_INVALIDPARAM);
+    EXPECT_EQ(countMirrorMappings(), mappings);
+}
+
+
+TEST(CircularBuffer, TestMirroredInitializeFailure)
+{
+    // let the initialization of a mirrored circular buffer fail after the mapping
+    // neither the mapping nor a descriptor should be left behind
+
+    rlimit limit, lowered;
+    CircularBufferInit cbInit;
+    CircularBuffer cb;
+
+    cbInit.pBuffer = NULL;
+    cbInit.nBufferSize = 100;
+    cbInit.pfnMutexInitialize = NULL;
+    cbInit.pfnMutexLock = NULL;
+    cbInit.pfnMutexRelease = NULL;
+
+    uint32_t mappings = countMirrorMappings();
+    int lowestFd = dup(0);
+
+    ASSERT_GE(lowestFd, 0);
+    close(lowestFd);
+
+    // the memfd and the readable eventfd fit under the limit, the writable eventfd does not
+    ASSERT_EQ(getrlimit(RLIMIT_NOFILE, &limit), 0);
+    lowered = limit;
+    lowered.rlim_cur = lowestFd + 1;
+    ASSERT_EQ(setrlimit(RLIMIT_NOFILE, &lowered), 0);
+
+    int32_t status = circularBufferInitializeWithFlags(&cb, cbInit, LIBCB_FLAG_MIRRORED | LIBCB_FLAG_EVENTFD);
+
+    setrlimit(RLIMIT_NOFILE, &limit);
+
+    EXPECT_EQ(status, LIBCB_SYSTEMERROR);
+    EXPECT_EQ(countMirrorMappings(), mappings);
+
+    int nextFd = dup(0);
+
+    EXPECT_EQ(nextFd, lowestFd);
+    close(nextFd);
+
+    // a failing mutex callback comes after both eventfds are open
+    cbInit.pfnMutexInitialize = [](uint32_t **) -> int32_t { return -1; };
+
+    EXPECT_EQ(circularBufferInitializeWithFlags(&cb, cbInit, LIBCB_FLAG_MIRRORED | LIBCB_FLAG_EVENTFD), LIBCB_MUTEXERROR);
+    EXPECT_EQ(countMirrorMappings(), mappings);
+
+    nextFd = dup(0);
+
+    EXPECT_EQ(nextFd, lowestFd);
+    close(nextFd);
+}
+
+TEST(CircularBuffer, TestOverwriteOldest)
+{
+    // create an overwriting circular buffer and push more data than it can hold
+    // the oldest bytes should be dropped and accounted for
+
+    int32_t status;
+    uint8_t buffer[10], dataToPush[10], dataToCompare[10];
+    uint32_t bufferSize = 10;
+    uint64_t droppedBytes, droppedRecords;
+    CircularBufferInit cbInit;
+    CircularBuffer cb;
+
+    cbInit.pBuffer = buffer;
+    cbInit.nBufferSize = bufferSize;
+    cbInit.pfnMutexInitialize = NULL;
+    cbInit.pfnMutexLock = NULL;
+    cbInit.pfnMutexRelease = NULL;
+
+    status = circularBufferInitializeWithFlags(&cb, cbInit, LIBCB_FLAG_OVERWRITE);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+
+    for (uint32_t i = 0; i < bufferSize; i++)
+    {
+        dataToPush[i] = (uint8_t)i;
+    }
+
+    status = circularBufferPush(&cb, dataToPush, 7);
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+    status = circularBufferPush(&cb, dataToPush + 7, 3);
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+    status = circularBufferPush(&cb, dataToPush, 4);
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+
+    EXPECT_EQ(cb.nCount, 10);
+    EXPECT_EQ(cb.nHead, 4);
+
+    // more than the whole buffer can never fit, nothing should be dropped for it
+    status = circularBufferPush(&cb, dataToPush, bufferSize + 1);
+    EXPECT_EQ(status, LIBCB_BUFFEROVERFLOW);
+    EXPECT_EQ(cb.nCount, 10);
+
+    status = circularBufferGetDropped(&cb, &droppedBytes, &droppedRecords);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+    EXPECT_EQ(droppedBytes, 4u);
+    EXPECT_EQ(droppedRecords, 0u);
+
+    status = circularBufferPop(&cb, dataToCompare, 10);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+    EXPECT_EQ(memcmp(dataToCompare, dataToPush + 4, 6), 0);
+    EXPECT_EQ(memcmp(dataToCompare + 6, dataToPush, 4), 0);
+
+
+    status = circularBufferInitializeWithFlags(&cb, cbInit, LIBCB_FLAG_OVERWRITE | LIBCB_FLAG_SPSC);
+
+    EXPECT_EQ(status, LIBCB_INVALIDPARAM);
+}
+
+TEST(CircularBuffer, TestPowerOfTwo)
+{
+    // create a power of two circular buffer from storage that is not a power of two
+    // the size should be rounded down and data should survive the index overflow
+
+    int32_t status;
+    uint8_t buffer[20], dataToPush[16], dataToCompare[16];
+    CircularBufferInit cbInit;
+    CircularBuffer cb;
+
+    cbInit.pBuffer = buffer;
+    cbInit.nBufferSize = sizeof(buffer);
+    cbInit.pfnMutexInitialize = NULL;
+    cbInit.pfnMutexLock = NULL;
+    cbInit.pfnMutexRelease = NULL;
+
+    status = circularBufferInitializeWithFlags(&cb, cbInit, LIBCB_FLAG_POWEROFTWO);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+    EXPECT_EQ(cb.init.nBufferSize, 16);
+
+    for (uint32_t i = 0; i < sizeof(dataToPush); i++)
+    {
+        dataToPush[i] = (uint8_t)i;
+    }
+
+    // park the free-running indexes just below the uint32_t overflow
+    cb.nHead = 0xFFFFFFF8u;
+    cb.nTail = 0xFFFFFFF8u;
+
+    status = circularBufferPush(&cb, dataToPush, 16);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferGetCount(&cb), 16);
+    EXPECT_EQ(cb.nTail, 8u);
+
+    status = circularBufferPush(&cb, dataToPush, 1);
+
+    EXPECT_EQ(status, LIBCB_BUFFEROVERFLOW);
+
+    status = circularBufferPop(&cb, dataToCompare, 12);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+    EXPECT_EQ(memcmp(dataToCompare, dataToPush, 12), 0);
+    EXPECT_EQ(circularBufferGetCount(&cb), 4);
+
+    status = circularBufferPush(&cb, dataToPush, 12);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+
+    status = circularBufferPop(&cb, dataToCompare, 16);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+    EXPECT_EQ(memcmp(dataToCompare, dataToPush + 12, 4), 0);
+    EXPECT_EQ(memcmp(dataToCompare + 4, dataToPush, 12), 0);
+    EXPECT_EQ(circularBufferGetCount(&cb), 0);
+
+    // the lock-free mode shares the same indexes
+
+    status = circularBufferInitializeWithFlags(&cb, cbInit, LIBCB_FLAG_POWEROFTWO | LIBCB_FLAG_SPSC);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+
+    cb.nHead = 0xFFFFFFFCu;
+    cb.nTail = 0xFFFFFFFCu;
+
+    status = circularBufferPush(&cb, dataToPush, 10);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferGetCount(&cb), 10);
+
+    status = circularBufferPop(&cb, dataToCompare, 10);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+    EXPECT_EQ(memcmp(dataToCompare, dataToPush, 10), 0);
+}
+
+TEST(CircularBuffer, TestLockPolicies)
+{
+    // run two producers and one consumer through every built-in lock policy
+    // the consumer should receive every element exactly once
+
+    const uint32_t policies[] = { LIBCB_FLAG_LOCKTICKET, LIBCB_FLAG_LOCKTTAS, LIBCB_FLAG_LOCKADAPTIVE };
+    const uint32_t perProducer = 20000;
+
+    for (uint32_t policy : policies)
+    {
+        int32_t status;
+        uint32_t buffer[16];
+        CircularBufferInit cbInit;
+        CircularBuffer cb;
+
+        cbInit.pBuffer = buffer;
+        cbInit.nBufferSize = sizeof(buffer);
+        cbInit.pfnMutexInitialize = NULL;
+        cbInit.pfnMutexLock = NULL;
+        cbInit.pfnMutexRelease = NULL;
+
+        status = circularBufferInitializeWithFlags(&cb, cbInit, policy);
+
+        EXPECT_EQ(status, LIBCB_SUCCESS);
+
+        auto producer = [&cb, perProducer](uint32_t first) {
+            for (uint32_t i = first; i < first + perProducer;)
+            {
+                if (circularBufferPush(&cb, &i, sizeof(i)) == LIBCB_SUCCESS)
+                {
+                    i++;
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        };
+
+        std::thread first(producer, 0), second(producer, perProducer);
+        uint64_t sum = 0;
+
+        for (uint32_t received = 0; received < 2 * perProducer;)
+        {
+            uint32_t value;
+
+            if (circularBufferPop(&cb, &value, sizeof(value)) == LIBCB_SUCCESS)
+            {
+                sum += value;
+                received++;
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        first.join();
+        second.join();
+
+        EXPECT_EQ(sum, (uint64_t)(2 * perProducer) * (2 * perProducer - 1) / 2);
+        EXPECT_EQ(circularBufferIsEmpty(&cb), TRUE);
+    }
+}
+
+static int32_t failingMutexLock(uint32_t *pMutex)
+{
+    (void)pMutex;
+
+    return -1;
+}
+
+static int32_t passingMutexRelease(uint32_t *pMutex)
+{
+    (void)pMutex;
+
+    return 0;
+}
+
+TEST(CircularBuffer, TestLockCallbackError)
+{
+    // create a circular buffer whose lock callback fails
+    // every locked operation should report the error and leave the content alone
+
+    int32_t status;
+    uint8_t buffer[10], data[4] = { 1, 2, 3, 4 };
+    CircularBufferInit cbInit;
+    CircularBuffer cb;
+
+    cbInit.pBuffer = buffer;
+    cbInit.nBufferSize = sizeof(buffer);
+    cbInit.pfnMutexInitialize = NULL;
+    cbInit.pfnMutexLock = failingMutexLock;
+    cbInit.pfnMutexRelease = passingMutexRelease;
+
+    status = circularBufferInitializeWithFlags(&cb, cbInit, LIBCB_FLAG_LOCKCALLBACK);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+
+    status = circularBufferPush(&cb, data, sizeof(data));
+
+    EXPECT_EQ(status, LIBCB_MUTEXERROR);
+    EXPECT_EQ(circularBufferGetCount(&cb), 0);
+
+    status = circularBufferPop(&cb, data, sizeof(data));
+
+    EXPECT_EQ(status, LIBCB_MUTEXERROR);
+
+    // an unknown lock policy is rejected
+
+    status = circularBufferInitializeWithFlags(&cb, cbInit, LIBCB_FLAG_LOCKMASK);
+
+    EXPECT_EQ(status, LIBCB_INVALIDPARAM);
+}
@@ -0,0 +1,219 @@
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include "gtest/gtest.h"
+#include "libCircularBuffer/CircularBuffer.hpp"
+
+TEST(CircularBufferCpp, TestEmplacePop)
+{
+    // create a ring of non-trivial elements and fill it past the wrap point
+    // elements should be moved out in order and the ring should refuse to overflow
+
+    libcb::Ring<std::unique_ptr<std::string>, 3> ring;
+    std::unique_ptr<std::string> value;
+
+    static_assert(libcb::Ring<std::unique_ptr<std::string>, 3>::capacity() == 3, "capacity is constexpr");
+
+    EXPECT_TRUE(ring.empty());
+
+    for (int i = 0; i < 10; i++)
+    {
+        EXPECT_TRUE(ring.emplace(new std::string(std::to_string(i))));
+        EXPECT_TRUE(ring.emplace(new std::string(std::to_string(i + 100))));
+        EXPECT_EQ(ring.size(), 2u);
+
+        EXPECT_TRUE(ring.pop(value));
+        EXPECT_EQ(*value, std::to_string(i));
+        EXPECT_TRUE(ring.pop(value));
+        EXPECT_EQ(*value, std::to_string(i + 100));
+    }
+
+    EXPECT_FALSE(ring.pop(value));
+
+    EXPECT_TRUE(ring.push(std::unique_ptr<std::string>(new std::string("a"))));
+    EXPECT_TRUE(ring.push(std::unique_ptr<std::string>(new std::string("b"))));
+    EXPECT_TRUE(ring.push(std::unique_ptr<std::string>(new std::string("c"))));
+    EXPECT_TRUE(ring.full());
+    EXPECT_FALSE(ring.push(std::unique_ptr<std::string>(new std::string("d"))));
+
+    // the remaining elements are destroyed with the ring
+}
+
+TEST(CircularBufferCpp, TestBulkPushPop)
+{
+    // push and pop trivially copyable elements in bulk across the wrap point
+    // a bulk push should stop at the capacity and a bulk pop at the content
+
+    libcb::Ring<uint32_t, 8> ring;
+    uint32_t values[12], result[12];
+
+    for (uint32_t i = 0; i < 12; i++)
+    {
+        values[i] = i;
+    }
+
+    EXPECT_EQ(ring.push(values, 5), 5u);
+    EXPECT_EQ(ring.pop(result, 3), 3u);
+    EXPECT_EQ(ring.push(values + 5, 7), 6u);
+    EXPECT_EQ(ring.size(), 8u);
+
+    EXPECT_EQ(ring.pop(result, 12), 8u);
+
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        EXPECT_EQ(result[i], i + 3);
+    }
+
+    // a capacity that is not a power of two takes the generic index math
+    libcb::Ring<std::string, 5> strings;
+    std::string words[4] = { "one", "two", "three", "four" }, out[4];
+
+    for (int lap = 0; lap < 3; lap++)
+    {
+        EXPECT_EQ(strings.push(words, 4), 4u);
+        EXPECT_EQ(strings.pop(out, 4), 4u);
+
+        for (int i = 0; i < 4; i++)
+        {
+            EXPECT_EQ(out[i], words[i]);
+        }
+    }
+}
+
+TEST(CircularBufferCpp, TestMutexLock)
+{
+    // one thread pushes and another pops through the mutex lock policy
+    // every value should arrive exactly once and in order
+
+    const uint32_t total = 100000;
+    libcb::Ring<uint32_t, 64, libcb::MutexLock> ring;
+    uint32_t outOfOrder = 0;
+
+    std::thread consumer([&ring, &outOfOrder, total]() {
+        uint32_t value;
+
+        for (uint32_t expected = 0; expected < total;)
+        {
+            if (!ring.pop(value))
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            outOfOrder += value != expected;
+            expected++;
+        }
+    });
+
+    for (uint32_t i = 0; i < total;)
+    {
+        if (ring.push(i))
+        {
+            i++;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    consumer.join();
+
+    EXPECT_EQ(outOfOrder, 0u);
+    EXPECT_TRUE(ring.empty());
+}
+
+// an element that counts its live instances and can be told to fail its copy
+struct Tracked
+{
+    static int live;
+    static int copiesLeft;
+    static int assignsLeft;
+
+    int value;
+
+    explicit Tracked(int v) : value(v) { live++; }
+
+    Tracked(const Tracked &other) : value(other.value)
+    {
+        if (copiesLeft == 0)
+        {
+            throw std::runtime_error("copy failed");
+        }
+
+        copiesLeft -= copiesLeft > 0;
+        live++;
+    }
+
+    Tracked &operator=(const Tracked &other)
+    {
+        if (assignsLeft == 0)
+        {
+            throw std::runtime_error("assignment failed");
+        }
+
+        assignsLeft -= assignsLeft > 0;
+        value = other.value;
+
+        return *this;
+    }
+
+    ~Tracked() { live--; }
+};
+
+int Tracked::live = 0;
+int Tracked::copiesLeft = -1;
+int Tracked::assignsLeft = -1;
+
+TEST(CircularBufferCpp, TestThrowingCopy)
+{
+    // let the third copy of a bulk push throw
+    // the two copies built before should be stored and destroyed with the ring
+
+    {
+        libcb::Ring<Tracked, 4> ring;
+        Tracked values[3] = { Tracked(1), Tracked(2), Tracked(3) };
+
+        Tracked::copiesLeft = 2;
+
+        EXPECT_THROW(ring.push(values, 3), std::runtime_error);
+        EXPECT_EQ(ring.size(), 2u);
+        EXPECT_EQ(Tracked::live, 5);
+
+        Tracked::copiesLeft = -1;
+    }
+
+    EXPECT_EQ(Tracked::live, 0);
+}
+
+TEST(CircularBufferCpp, TestThrowingMove)
+{
+    // let the second move of a bulk pop throw
+    // the element moved out before should not be destroyed a second time
+
+    {
+        libcb::Ring<Tracked, 4> ring;
+        Tracked values[3] = { Tracked(0), Tracked(0), Tracked(0) };
+
+        for (int i = 1; i <= 3; i++)
+        {
+            EXPECT_TRUE(ring.emplace(i));
+        }
+
+        Tracked::assignsLeft = 1;
+
+        EXPECT_THROW(ring.pop(values, 3), std::runtime_error);
+        EXPECT_EQ(ring.size(), 2u);
+        EXPECT_EQ(values[0].value, 1);
+        EXPECT_EQ(Tracked::live, 5);
+
+        Tracked::assignsLeft = -1;
+
+        EXPECT_EQ(ring.pop(values, 3), 2u);
+        EXPECT_EQ(values[0].value, 2);
+        EXPECT_EQ(values[1].value, 3);
+    }
+
+    EXPECT_EQ(Tracked::live, 0);
+}
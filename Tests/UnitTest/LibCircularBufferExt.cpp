@@ -1,3 +1,11 @@
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/epoll.h>
 #include "gtest/gtest.h"
 #include "libCircularBuffer/CircularBufferExt.h"
 
@@ -45,4 +53,1355 @@ TEST(CircularBufferExt, TestRead)
     EXPECT_EQ(cb.nTail, 1);
 
 
-}
\ No newline at end of file
+}
+
+TEST(CircularBufferExt, TestReserveCommit)
+{
+    // create an circular buffer and move the tail close to the end
+    // reserve a region that wraps, write into both spans and commit a part of it
+    // the committed bytes should pop in order
+
+    int32_t status;
+    uint8_t buffer[10], dataToCompare[10];
+    uint32_t bufferSize = 10;
+    CircularBufferInit cbInit;
+    CircularBuffer cb;
+    CircularBufferSpan spans[2];
+
+    cbInit.pBuffer = buffer;
+    cbInit.nBufferSize = bufferSize;
+    cbInit.pfnMutexInitialize = NULL;
+    cbInit.pfnMutexLock = NULL;
+    cbInit.pfnMutexRelease = NULL;
+
+    status = circularBufferInitialize(&cb, cbInit);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+
+    status = circularBufferPush(&cb, dataToCompare, 7);
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+    status = circularBufferPop(&cb, dataToCompare, 7);
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+
+    status = circularBufferReserve(&cb, 11, spans);
+
+    EXPECT_EQ(status, LIBCB_BUFFEROVERFLOW);
+
+    status = circularBufferReserve(&cb, 6, spans);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+    EXPECT_EQ(spans[0].pData, buffer + 7);
+    EXPECT_EQ(spans[0].nSize, 3u);
+    EXPECT_EQ(spans[1].pData, buffer);
+    EXPECT_EQ(spans[1].nSize, 3u);
+
+    for (uint32_t i = 0; i < 6; i++)
+    {
+        CircularBufferSpan &span = spans[i < spans[0].nSize ? 0 : 1];
+        uint32_t index = i < spans[0].nSize ? i : i - spans[0].nSize;
+
+        ((uint8_t *)span.pData)[index] = (uint8_t)(0xA0 + i);
+    }
+
+    status = circularBufferCommit(&cb, 5);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+    EXPECT_EQ(cb.nCount, 5);
+    EXPECT_EQ(cb.nTail, 2);
+
+    status = circularBufferCommit(&cb, 1);
+
+    EXPECT_EQ(status, LIBCB_INVALIDPARAM);
+
+    status = circularBufferPop(&cb, dataToCompare, 5);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        EXPECT_EQ(dataToCompare[i], 0xA0 + i);
+    }
+}
+
+
+TEST(CircularBufferExt, TestPeekConsume)
+{
+    // create an circular buffer whose content wraps around the end
+    // peek should return both regions in place and consume should skip bytes
+
+    int32_t status;
+    uint8_t buffer[10], dataToPush[10];
+    uint32_t bufferSize = 10;
+    CircularBufferInit cbInit;
+    CircularBuffer cb;
+    CircularBufferSpan spans[2];
+
+    cbInit.pBuffer = buffer;
+    cbInit.nBufferSize = bufferSize;
+    cbInit.pfnMutexInitialize = NULL;
+    cbInit.pfnMutexLock = NULL;
+    cbInit.pfnMutexRelease = NULL;
+
+    status = circularBufferInitialize(&cb, cbInit);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+
+    status = circularBufferPeek(&cb, spans);
+
+    EXPECT_EQ(status, LIBCB_BUFFEREMPTY);
+
+    for (uint32_t i = 0; i < bufferSize; i++)
+    {
+        dataToPush[i] = (uint8_t)i;
+    }
+
+    status = circularBufferPush(&cb, dataToPush, 8);
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+    status = circularBufferPop(&cb, dataToPush, 6);
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+    status = circularBufferPush(&cb, dataToPush, 5);
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+
+    status = circularBufferPeek(&cb, spans);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+    EXPECT_EQ(spans[0].pData, buffer + 6);
+    EXPECT_EQ(spans[0].nSize, 4u);
+    EXPECT_EQ(spans[1].pData, buffer);
+    EXPECT_EQ(spans[1].nSize, 3u);
+
+    status = circularBufferConsume(&cb, 5);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+    EXPECT_EQ(cb.nCount, 2);
+    EXPECT_EQ(cb.nHead, 1);
+
+    status = circularBufferConsume(&cb, 1);
+
+    EXPECT_EQ(status, LIBCB_INVALIDPARAM);
+
+    status = circularBufferPeek(&cb, spans);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+    EXPECT_EQ(spans[0].pData, buffer + 1);
+    EXPECT_EQ(spans[0].nSize, 2u);
+    EXPECT_EQ(spans[1].nSize, 0u);
+
+    status = circularBufferConsume(&cb, 2);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferIsEmpty(&cb), TRUE);
+}
+
+
+TEST(CircularBufferExt, TestRecordPushPop)
+{
+    // create a record circular buffer and push variable size records across the end
+    // every record should come back whole with its own size
+
+    int32_t status;
+    uint8_t buffer[32], dataToPush[16], dataToCompare[16];
+    uint32_t bufferSize = 32, size;
+    CircularBufferInit cbInit;
+    CircularBuffer cb;
+
+    cbInit.pBuffer = buffer;
+    cbInit.nBufferSize = bufferSize;
+    cbInit.pfnMutexInitialize = NULL;
+    cbInit.pfnMutexLock = NULL;
+    cbInit.pfnMutexRelease = NULL;
+
+    status = circularBufferInitializeWithFlags(&cb, cbInit, LIBCB_FLAG_RECORD);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferGetNextRecordSize(&cb), LIBCB_BUFFEREMPTY);
+
+    for (uint32_t i = 0; i < sizeof(dataToPush); i++)
+    {
+        dataToPush[i] = (uint8_t)i;
+    }
+
+    for (uint32_t round = 0; round < 20; round++)
+    {
+        uint32_t first = 1 + round % 11, second = 1 + (round * 7) % 13;
+
+        status = circularBufferPushRecord(&cb, dataToPush, first);
+        EXPECT_EQ(status, LIBCB_SUCCESS);
+        status = circularBufferPushRecord(&cb, dataToPush + 1, second);
+        EXPECT_EQ(status, LIBCB_SUCCESS);
+
+        EXPECT_EQ(circularBufferGetNextRecordSize(&cb), (int32_t)first);
+
+        status = circularBufferPopRecord(&cb, dataToCompare, first - 1, &size);
+        EXPECT_EQ(status, LIBCB_BUFFEROVERFLOW);
+
+        status = circularBufferPopRecord(&cb, dataToCompare, sizeof(dataToCompare), &size);
+        EXPECT_EQ(status, LIBCB_SUCCESS);
+        EXPECT_EQ(size, first);
+        EXPECT_EQ(memcmp(dataToCompare, dataToPush, first), 0);
+
+        status = circularBufferPopRecord(&cb, dataToCompare, sizeof(dataToCompare), &size);
+        EXPECT_EQ(status, LIBCB_SUCCESS);
+        EXPECT_EQ(size, second);
+        EXPECT_EQ(memcmp(dataToCompare, dataToPush + 1, second), 0);
+
+        EXPECT_EQ(circularBufferIsEmpty(&cb), TRUE);
+    }
+
+    status = circularBufferPushRecord(&cb, dataToPush, bufferSize - LIBCB_RECORD_HEADER_SIZE + 1);
+
+    EXPECT_EQ(status, LIBCB_BUFFEROVERFLOW);
+}
+
+TEST(CircularBufferExt, TestRecordNoWrap)
+{
+    // create a record circular buffer with padding and push a record that would wrap
+    // the record should start at the beginning of the buffer and be contiguous
+
+    int32_t status;
+    uint8_t buffer[32], dataToPush[16], dataToCompare[16];
+    uint32_t bufferSize = 32, size;
+    CircularBufferInit cbInit;
+    CircularBuffer cb;
+    CircularBufferSpan spans[2];
+
+    cbInit.pBuffer = buffer;
+    cbInit.nBufferSize = bufferSize;
+    cbInit.pfnMutexInitialize = NULL;
+    cbInit.pfnMutexLock = NULL;
+    cbInit.pfnMutexRelease = NULL;
+
+    status = circularBufferInitializeWithFlags(&cb, cbInit, LIBCB_FLAG_RECORD | LIBCB_FLAG_RECORDNOWRAP);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+
+    for (uint32_t i = 0; i < sizeof(dataToPush); i++)
+    {
+        dataToPush[i] = (uint8_t)(0x40 + i);
+    }
+
+    // leave 6 bytes at the end, enough for a padding marker
+    status = circularBufferPushRecord(&cb, dataToPush, 16);
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+    status = circularBufferPushRecord(&cb, dataToPush, 2);
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+    status = circularBufferPopRecord(&cb, dataToCompare, sizeof(dataToCompare), &size);
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+
+    status = circularBufferPushRecord(&cb, dataToPush, 8);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+    EXPECT_EQ(cb.nTail, 12);
+    EXPECT_EQ(cb.nCount, 6 + 6 + 12);
+    EXPECT_EQ(memcmp(buffer + LIBCB_RECORD_HEADER_SIZE, dataToPush, 8), 0);
+
+    status = circularBufferPopRecord(&cb, dataToCompare, sizeof(dataToCompare), &size);
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+    EXPECT_EQ(size, 2u);
+
+    EXPECT_EQ(circularBufferGetNextRecordSize(&cb), 8);
+
+    status = circularBufferPopRecord(&cb, dataToCompare, sizeof(dataToCompare), &size);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+    EXPECT_EQ(size, 8u);
+    EXPECT_EQ(memcmp(dataToCompare, dataToPush, 8), 0);
+    EXPECT_EQ(circularBufferIsEmpty(&cb), TRUE);
+
+    // raw access would bypass the record framing
+    EXPECT_EQ(circularBufferReserve(&cb, 4, spans), LIBCB_INVALIDPARAM);
+    EXPECT_EQ(circularBufferPeek(&cb, spans), LIBCB_INVALIDPARAM);
+    EXPECT_EQ(circularBufferConsume(&cb, 0), LIBCB_INVALIDPARAM);
+}
+
+
+TEST(CircularBufferExt, TestPushvPopv)
+{
+    // create an circular buffer and push a batch of buffers in one call
+    // an all-or-nothing batch that does not fit should leave the buffer untouched
+    // a partial batch should move the leading buffers that fit
+
+    int32_t status;
+    uint8_t buffer[10], first[4] = { 1, 2, 3, 4 }, second[3] = { 5, 6, 7 }, third[5] = { 8, 9, 10, 11, 12 };
+    uint8_t out[3][5];
+    uint32_t bufferSize = 10;
+    CircularBufferInit cbInit;
+    CircularBuffer cb;
+    CircularBufferSpan sources[3] = { { first, 4 }, { second, 3 }, { third, 5 } };
+    CircularBufferSpan destinations[3] = { { out[0], 4 }, { out[1], 3 }, { out[2], 5 } };
+
+    cbInit.pBuffer = buffer;
+    cbInit.nBufferSize = bufferSize;
+    cbInit.pfnMutexInitialize = NULL;
+    cbInit.pfnMutexLock = NULL;
+    cbInit.pfnMutexRelease = NULL;
+
+    status = circularBufferInitialize(&cb, cbInit);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+
+    status = circularBufferPushv(&cb, sources, 3, LIBCB_BATCH_ALLORNOTHING);
+
+    EXPECT_EQ(status, LIBCB_BUFFEROVERFLOW);
+    EXPECT_EQ(cb.nCount, 0);
+    EXPECT_EQ(cb.nTail, 0);
+
+    status = circularBufferPushv(&cb, sources, 3, LIBCB_BATCH_PARTIAL);
+
+    EXPECT_EQ(status, 2);
+    EXPECT_EQ(cb.nCount, 7);
+    EXPECT_EQ(cb.nTail, 7);
+
+    status = circularBufferPopv(&cb, destinations, 3, LIBCB_BATCH_ALLORNOTHING);
+
+    EXPECT_EQ(status, LIBCB_BUFFERUNDERFLOW);
+    EXPECT_EQ(cb.nCount, 7);
+
+    status = circularBufferPopv(&cb, destinations, 3, LIBCB_BATCH_PARTIAL);
+
+    EXPECT_EQ(status, 2);
+    EXPECT_EQ(memcmp(out[0], first, 4), 0);
+    EXPECT_EQ(memcmp(out[1], second, 3), 0);
+    EXPECT_EQ(circularBufferIsEmpty(&cb), TRUE);
+}
+
+TEST(CircularBufferExt, TestPushvPopvRecords)
+{
+    // create a record circular buffer and push a batch, every buffer becomes a record
+    // the batch pop should report the size of every record
+
+    int32_t status;
+    uint8_t buffer[64], first[4] = { 1, 2, 3, 4 }, second[3] = { 5, 6, 7 };
+    uint8_t out[2][8];
+    uint32_t bufferSize = 64;
+    CircularBufferInit cbInit;
+    CircularBuffer cb;
+    CircularBufferSpan sources[2] = { { first, 4 }, { second, 3 } };
+    CircularBufferSpan destinations[3] = { { out[0], 8 }, { out[1], 8 }, { out[1], 8 } };
+
+    cbInit.pBuffer = buffer;
+    cbInit.nBufferSize = bufferSize;
+    cbInit.pfnMutexInitialize = NULL;
+    cbInit.pfnMutexLock = NULL;
+    cbInit.pfnMutexRelease = NULL;
+
+    status = circularBufferInitializeWithFlags(&cb, cbInit, LIBCB_FLAG_RECORD);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+
+    status = circularBufferPushv(&cb, sources, 2, LIBCB_BATCH_ALLORNOTHING);
+
+    EXPECT_EQ(status, 2);
+    EXPECT_EQ(cb.nCount, 2 * LIBCB_RECORD_HEADER_SIZE + 7);
+
+    status = circularBufferPopv(&cb, destinations, 3, LIBCB_BATCH_ALLORNOTHING);
+
+    EXPECT_EQ(status, LIBCB_BUFFERUNDERFLOW);
+    EXPECT_EQ(destinations[0].nSize, 8u);
+
+    status = circularBufferPopv(&cb, destinations, 3, LIBCB_BATCH_PARTIAL);
+
+    EXPECT_EQ(status, 2);
+    EXPECT_EQ(destinations[0].nSize, 4u);
+    EXPECT_EQ(destinations[1].nSize, 3u);
+    EXPECT_EQ(memcmp(out[0], first, 4), 0);
+    EXPECT_EQ(memcmp(out[1], second, 3), 0);
+    EXPECT_EQ(circularBufferIsEmpty(&cb), TRUE);
+}
+
+
+TEST(CircularBufferExt, TestPartialPushPop)
+{
+    // create an circular buffer and push more data than it can hold
+    // the partial push should take what fits and the partial pop should drain it
+
+    int32_t status;
+    uint8_t buffer[10], dataToPush[16], dataToCompare[16];
+    uint32_t bufferSize = 10;
+    CircularBufferInit cbInit;
+    CircularBuffer cb;
+
+    cbInit.pBuffer = buffer;
+    cbInit.nBufferSize = bufferSize;
+    cbInit.pfnMutexInitialize = NULL;
+    cbInit.pfnMutexLock = NULL;
+    cbInit.pfnMutexRelease = NULL;
+
+    status = circularBufferInitialize(&cb, cbInit);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+
+    for (uint32_t i = 0; i < sizeof(dataToPush); i++)
+    {
+        dataToPush[i] = (uint8_t)i;
+    }
+
+    status = circularBufferPopPartial(&cb, dataToCompare, sizeof(dataToCompare));
+
+    EXPECT_EQ(status, 0);
+
+    status = circularBufferPushPartial(&cb, dataToPush, 6);
+
+    EXPECT_EQ(status, 6);
+
+    status = circularBufferPopPartial(&cb, dataToCompare, 4);
+
+    EXPECT_EQ(status, 4);
+
+    status = circularBufferPushPartial(&cb, dataToPush + 6, 10);
+
+    EXPECT_EQ(status, 8);
+    EXPECT_EQ(circularBufferIsFull(&cb), TRUE);
+
+    status = circularBufferPushPartial(&cb, dataToPush, 1);
+
+    EXPECT_EQ(status, 0);
+
+    status = circularBufferPopPartial(&cb, dataToCompare, sizeof(dataToCompare));
+
+    EXPECT_EQ(status, 10);
+    EXPECT_EQ(memcmp(dataToCompare, dataToPush + 4, 10), 0);
+    EXPECT_EQ(circularBufferIsEmpty(&cb), TRUE);
+}
+
+
+TEST(CircularBufferExt, TestWaitTimeout)
+{
+    // create a blocking circular buffer and wait on it while it is empty and full
+    // both waits should give up after the timeout
+
+    int32_t status;
+    uint8_t buffer[8], data[8] = {};
+    uint32_t bufferSize = 8;
+    CircularBufferInit cbInit;
+    CircularBuffer cb;
+
+    cbInit.pBuffer = buffer;
+    cbInit.nBufferSize = bufferSize;
+    cbInit.pfnMutexInitialize = NULL;
+    cbInit.pfnMutexLock = NULL;
+    cbInit.pfnMutexRelease = NULL;
+
+    status = circularBufferInitializeWithFlags(&cb, cbInit, LIBCB_FLAG_BLOCKING);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+
+    // without LIBCB_FLAG_EVENTFD there is no descriptor to signal
+    EXPECT_EQ(cb.nReadArmed, 0u);
+
+    status = circularBufferPopWait(&cb, data, 1, 10);
+
+    EXPECT_EQ(status, LIBCB_TIMEOUT);
+
+    status = circularBufferPushWait(&cb, data, 8, 10);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+
+    status = circularBufferPushWait(&cb, data, 1, 10);
+
+    EXPECT_EQ(status, LIBCB_TIMEOUT);
+    EXPECT_EQ(cb.nPushWaiters, 0u);
+    EXPECT_EQ(cb.nPopWaiters, 0u);
+}
+
+TEST(CircularBufferExt, TestWaitProducerConsumer)
+{
+    // create a small lock-free blocking circular buffer and move a stream of bytes
+    // through it with a producer and a consumer that both park when they cannot proceed
+
+    int32_t status;
+    uint8_t buffer[16];
+    uint32_t bufferSize = 16, totalBytes = 1u << 16;
+    CircularBufferInit cbInit;
+    CircularBuffer cb;
+
+    cbInit.pBuffer = buffer;
+    cbInit.nBufferSize = bufferSize;
+    cbInit.pfnMutexInitialize = NULL;
+    cbInit.pfnMutexLock = NULL;
+    cbInit.pfnMutexRelease = NULL;
+
+    status = circularBufferInitializeWithFlags(&cb, cbInit, LIBCB_FLAG_SPSC | LIBCB_FLAG_BLOCKING);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+
+    std::thread producer([&cb, totalBytes]() {
+        for (uint32_t i = 0; i < totalBytes; i += 4)
+        {
+            uint32_t value = i;
+
+            circularBufferPushWait(&cb, &value, sizeof(value), LIBCB_WAIT_FOREVER);
+        }
+    });
+
+    uint32_t mismatches = 0;
+
+    for (uint32_t i = 0; i < totalBytes; i += 4)
+    {
+        uint32_t value = 0;
+
+        status = circularBufferPopWait(&cb, &value, sizeof(value), LIBCB_WAIT_FOREVER);
+
+        mismatches += status != LIBCB_SUCCESS || value != i;
+    }
+
+    producer.join();
+
+    EXPECT_EQ(mismatches, 0u);
+    EXPECT_EQ(circularBufferIsEmpty(&cb), TRUE);
+}
+
+TEST(CircularBufferExt, TestOverwriteRecords)
+{
+    // create an overwriting record circular buffer and keep pushing records
+    // whole records should be dropped so the remaining ones stay intact
+
+    int32_t status;
+    uint8_t buffer[32], dataToCompare[16];
+    uint32_t bufferSize = 32, size;
+    uint64_t droppedBytes, droppedRecords;
+    CircularBufferInit cbInit;
+    CircularBuffer cb;
+
+    cbInit.pBuffer = buffer;
+    cbInit.nBufferSize = bufferSize;
+    cbInit.pfnMutexInitialize = NULL;
+    cbInit.pfnMutexLock = NULL;
+    cbInit.pfnMutexRelease = NULL;
+
+    status = circularBufferInitializeWithFlags(&cb, cbInit, LIBCB_FLAG_RECORD | LIBCB_FLAG_OVERWRITE);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+
+    // every record takes 10 bytes, only three fit
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        uint8_t record[6];
+
+        memset(record, (int)i, sizeof(record));
+
+        status = circularBufferPushRecord(&cb, record, sizeof(record));
+        EXPECT_EQ(status, LIBCB_SUCCESS);
+    }
+
+    status = circularBufferGetDropped(&cb, &droppedBytes, &droppedRecords);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+    EXPECT_EQ(droppedRecords, 2u);
+    EXPECT_EQ(droppedBytes, 20u);
+
+    // a record larger than the whole buffer should fail without dropping any
+    {
+        uint8_t record[200] = { 0 };
+
+        status = circularBufferPushRecord(&cb, record, sizeof(record));
+        EXPECT_EQ(status, LIBCB_BUFFEROVERFLOW);
+
+        status = circularBufferPushRecord(&cb, record, bufferSize - 3);
+        EXPECT_EQ(status, LIBCB_BUFFEROVERFLOW);
+    }
+
+    status = circularBufferGetDropped(&cb, &droppedBytes, &droppedRecords);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+    EXPECT_EQ(droppedRecords, 2u);
+    EXPECT_EQ(circularBufferGetCount(&cb), 30);
+
+    for (uint32_t i = 2; i < 5; i++)
+    {
+        status = circularBufferPopRecord(&cb, dataToCompare, sizeof(dataToCompare), &size);
+
+        EXPECT_EQ(status, LIBCB_SUCCESS);
+        EXPECT_EQ(size, 6u);
+        EXPECT_EQ(dataToCompare[0], i);
+        EXPECT_EQ(dataToCompare[5], i);
+    }
+
+    EXPECT_EQ(circularBufferIsEmpty(&cb), TRUE);
+}
+
+TEST(CircularBufferExt, TestFdReadWrite)
+{
+    // relay data from one pipe into another through the circular buffer
+    // the free and used regions wrap, a drained non-blocking pipe reports
+    // LIBCB_WOULDBLOCK and a closed one the end of the file
+
+    int32_t status;
+    uint8_t buffer[16], data[12], result[12];
+    int input[2], output[2];
+    CircularBufferInit cbInit;
+    CircularBuffer cb;
+
+    cbInit.pBuffer = buffer;
+    cbInit.nBufferSize = sizeof(buffer);
+    cbInit.pfnMutexInitialize = NULL;
+    cbInit.pfnMutexLock = NULL;
+    cbInit.pfnMutexRelease = NULL;
+
+    status = circularBufferInitialize(&cb, cbInit);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+    ASSERT_EQ(pipe(input), 0);
+    ASSERT_EQ(pipe(output), 0);
+
+    fcntl(input[0], F_SETFL, fcntl(input[0], F_GETFL) | O_NONBLOCK);
+
+    for (uint32_t i = 0; i < sizeof(data); i++)
+    {
+        data[i] = (uint8_t)(i + 1);
+    }
+
+    // move the indexes so the free space wraps
+    circularBufferPush(&cb, data, 10);
+    circularBufferPop(&cb, result, 10);
+
+    status = circularBufferReadFromFd(&cb, input[0], 0);
+
+    EXPECT_EQ(status, LIBCB_WOULDBLOCK);
+
+    EXPECT_EQ(write(input[1], data, sizeof(data)), (ssize_t)sizeof(data));
+
+    status = circularBufferReadFromFd(&cb, input[0], 0);
+
+    EXPECT_EQ(status, (int32_t)sizeof(data));
+    EXPECT_EQ(circularBufferGetCount(&cb), (int32_t)sizeof(data));
+
+    status = circularBufferWriteToFd(&cb, output[1], 5);
+
+    EXPECT_EQ(status, 5);
+
+    status = circularBufferWriteToFd(&cb, output[1], 0);
+
+    EXPECT_EQ(status, 7);
+
+    status = circularBufferWriteToFd(&cb, output[1], 0);
+
+    EXPECT_EQ(status, LIBCB_BUFFEREMPTY);
+    EXPECT_EQ(read(output[0], result, sizeof(result)), (ssize_t)sizeof(result));
+    EXPECT_EQ(memcmp(result, data, sizeof(data)), 0);
+
+    close(input[1]);
+
+    status = circularBufferReadFromFd(&cb, input[0], 0);
+
+    EXPECT_EQ(status, 0);
+
+    close(input[0]);
+    close(output[0]);
+    close(output[1]);
+}
+
+static bool isSignalled(int32_t fd)
+{
+    struct pollfd pollFd = { fd, POLLIN, 0 };
+
+    return poll(&pollFd, 1, 0) == 1;
+}
+
+static uint64_t drainEvent(int32_t fd)
+{
+    uint64_t counter = 0;
+
+    return read(fd, &counter, sizeof(counter)) == sizeof(counter) ? counter : 0;
+}
+
+TEST(CircularBufferExt, TestEventFdEdges)
+{
+    // create a circular buffer with readiness eventfds
+    // they should only be signalled on the empty and full edges a side has seen
+
+    int32_t status, readableFd, writableFd;
+    uint8_t buffer[8], data[8] = { 0 };
+    CircularBufferInit cbInit;
+    CircularBuffer cb;
+
+    cbInit.pBuffer = buffer;
+    cbInit.nBufferSize = sizeof(buffer);
+    cbInit.pfnMutexInitialize = NULL;
+    cbInit.pfnMutexLock = NULL;
+    cbInit.pfnMutexRelease = NULL;
+
+    status = circularBufferInitializeWithFlags(&cb, cbInit, LIBCB_FLAG_EVENTFD);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+
+    readableFd = circularBufferGetReadableFd(&cb);
+    writableFd = circularBufferGetWritableFd(&cb);
+
+    ASSERT_GE(readableFd, 0);
+    ASSERT_GE(writableFd, 0);
+    EXPECT_FALSE(isSignalled(readableFd));
+    EXPECT_TRUE(isSignalled(writableFd));
+    EXPECT_EQ(drainEvent(writableFd), 1u);
+
+    // the first push into the new buffer is an edge, the second is not
+    EXPECT_EQ(circularBufferPush(&cb, data, 4), LIBCB_SUCCESS);
+    EXPECT_TRUE(isSignalled(readableFd));
+    EXPECT_EQ(drainEvent(readableFd), 1u);
+    EXPECT_EQ(circularBufferPush(&cb, data, 4), LIBCB_SUCCESS);
+    EXPECT_FALSE(isSignalled(readableFd));
+
+    // a full buffer arms the writable side, the next pop signals it
+    EXPECT_EQ(circularBufferPush(&cb, data, 1), LIBCB_BUFFEROVERFLOW);
+    EXPECT_FALSE(isSignalled(writableFd));
+    EXPECT_EQ(circularBufferPop(&cb, data, 2), LIBCB_SUCCESS);
+    EXPECT_TRUE(isSignalled(writableFd));
+    EXPECT_EQ(drainEvent(writableFd), 1u);
+    EXPECT_EQ(circularBufferPop(&cb, data, 2), LIBCB_SUCCESS);
+    EXPECT_FALSE(isSignalled(writableFd));
+
+    // draining to empty arms the readable side again
+    EXPECT_EQ(circularBufferPop(&cb, data, 4), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferPop(&cb, data, 1), LIBCB_BUFFEREMPTY);
+    EXPECT_FALSE(isSignalled(readableFd));
+    EXPECT_EQ(circularBufferPush(&cb, data, 1), LIBCB_SUCCESS);
+    EXPECT_TRUE(isSignalled(readableFd));
+    EXPECT_EQ(drainEvent(readableFd), 1u);
+
+    // a read that hits end of file adds nothing and must not signal the armed consumer
+    int pipeFds[2];
+
+    EXPECT_EQ(circularBufferPop(&cb, data, 1), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferPop(&cb, data, 1), LIBCB_BUFFEREMPTY);
+    ASSERT_EQ(pipe(pipeFds), 0);
+    close(pipeFds[1]);
+    EXPECT_EQ(circularBufferReadFromFd(&cb, pipeFds[0], 0), 0);
+    EXPECT_FALSE(isSignalled(readableFd));
+    close(pipeFds[0]);
+
+    EXPECT_EQ(circularBufferPush(&cb, data, 1), LIBCB_SUCCESS);
+    EXPECT_TRUE(isSignalled(readableFd));
+
+    status = circularBufferDeinitialize(&cb);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+    EXPECT_EQ(fcntl(readableFd, F_GETFD), -1);
+}
+
+TEST(CircularBufferExt, TestEventFdEpoll)
+{
+    // run a lock-free producer thread against a consumer driven by epoll
+    // the consumer should never sit in epoll_wait while data is pending
+
+    const uint32_t total = 20000;
+    int32_t status;
+    uint32_t buffer[16];
+    CircularBufferInit cbInit;
+    CircularBuffer cb;
+
+    cbInit.pBuffer = buffer;
+    cbInit.nBufferSize = sizeof(buffer);
+    cbInit.pfnMutexInitialize = NULL;
+    cbInit.pfnMutexLock = NULL;
+    cbInit.pfnMutexRelease = NULL;
+
+    status = circularBufferInitializeWithFlags(&cb, cbInit, LIBCB_FLAG_EVENTFD | LIBCB_FLAG_SPSC);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+
+    int epollFd = epoll_create1(0);
+    struct epoll_event event = {};
+
+    event.events = EPOLLIN;
+    event.data.fd = circularBufferGetReadableFd(&cb);
+
+    ASSERT_EQ(epoll_ctl(epollFd, EPOLL_CTL_ADD, event.data.fd, &event), 0);
+
+    std::thread producer([&cb, total]() {
+        for (uint32_t i = 0; i < total;)
+        {
+            if (circularBufferPush(&cb, &i, sizeof(i)) == LIBCB_SUCCESS)
+            {
+                i++;
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint32_t received = 0, mismatches = 0, value;
+
+    while (received < total)
+    {
+        if (epoll_wait(epollFd, &event, 1, 5000) != 1)
+        {
+            break;
+        }
+
+        drainEvent(event.data.fd);
+
+        while (circularBufferPop(&cb, &value, sizeof(value)) == LIBCB_SUCCESS)
+        {
+            mismatches += value != received;
+            received++;
+        }
+    }
+
+    producer.join();
+
+    EXPECT_EQ(received, total);
+    EXPECT_EQ(mismatches, 0u);
+
+    close(epollFd);
+    circularBufferDeinitialize(&cb);
+}
+
+TEST(CircularBufferExt, TestStatistics)
+{
+    // push and pop through the locked and the lock-free mode, including rejected calls
+    // the counters should match the calls and a reset snapshot should clear them
+
+    int32_t status;
+    uint8_t buffer[64], data[48] = {}, result[64];
+    CircularBuffer cb;
+    CircularBufferInit cbInit;
+    CircularBufferStatistics stats;
+
+    cbInit.pBuffer = buffer;
+    cbInit.nBufferSize = sizeof(buffer);
+    cbInit.pfnMutexInitialize = NULL;
+    cbInit.pfnMutexLock = NULL;
+    cbInit.pfnMutexRelease = NULL;
+
+    for (uint32_t nFlags : { LIBCB_FLAG_LOCKTTAS, LIBCB_FLAG_LOCKTTAS | LIBCB_FLAG_EVENTFD, LIBCB_FLAG_SPSC })
+    {
+
+        status = circularBufferInitializeWithFlags(&cb, cbInit, nFlags);
+
+        ASSERT_EQ(status, LIBCB_SUCCESS);
+
+        EXPECT_EQ(circularBufferPush(&cb, data, 16), LIBCB_SUCCESS);
+        EXPECT_EQ(circularBufferPush(&cb, data, 32), LIBCB_SUCCESS);
+        EXPECT_EQ(circularBufferPush(&cb, data, 32), LIBCB_BUFFEROVERFLOW);
+        EXPECT_EQ(circularBufferPop(&cb, data, 40), LIBCB_SUCCESS);
+        EXPECT_EQ(circularBufferPushPartial(&cb, data, 48), 48);
+        EXPECT_EQ(circularBufferPop(&cb, result, sizeof(result)), LIBCB_BUFFERUNDERFLOW);
+
+        status = circularBufferGetStatistics(&cb, &stats, TRUE);
+
+#ifdef LIBCB_ENABLE_STATISTICS
+        EXPECT_EQ(status, LIBCB_SUCCESS);
+        EXPECT_EQ(stats.nPushedBytes, 96u);
+        EXPECT_EQ(stats.nPushes, 3u);
+        EXPECT_EQ(stats.nPoppedBytes, 40u);
+        EXPECT_EQ(stats.nPops, 1u);
+        EXPECT_EQ(stats.nOverflows, 1u);
+        EXPECT_EQ(stats.nUnderflows, 1u);
+        EXPECT_EQ(stats.nHighWater, 56u);
+
+        // only the locked mode takes the lock, once per call even when a
+        // failed call re-checks the level to arm its descriptor
+        EXPECT_EQ(stats.nLockAcquires, nFlags == LIBCB_FLAG_SPSC ? 0u : 6u);
+        EXPECT_GE(stats.nLockWaitNs, stats.nLockWaitMaxNs);
+
+        EXPECT_EQ(circularBufferGetStatistics(&cb, &stats, FALSE), LIBCB_SUCCESS);
+        EXPECT_EQ(stats.nPushedBytes, 0u);
+        EXPECT_EQ(stats.nHighWater, 0u);
+        EXPECT_EQ(stats.nLockAcquires, 0u);
+#else
+        EXPECT_EQ(status, LIBCB_NOTSUPPORTED);
+#endif
+
+        circularBufferDeinitialize(&cb);
+    }
+}
+
+TEST(CircularBufferExt, TestCopyKernels)
+{
+    // round trip a payload above the streaming threshold through every copy kernel
+    // the content has to wrap, a kernel the CPU lacks has to be refused up front
+
+    int32_t status;
+    uint32_t size = LIBCB_COPY_STREAM_THRESHOLD + 100;
+    std::vector<uint8_t> buffer(size + 37), data(size), result(size);
+    CircularBuffer cb;
+    CircularBufferInit cbInit;
+
+    for (uint32_t i = 0; i < size; i++)
+    {
+        data[i] = (uint8_t)(i * 7 + 3);
+    }
+
+    cbInit.pBuffer = buffer.data();
+    cbInit.nBufferSize = (uint32_t)buffer.size();
+    cbInit.pfnMutexInitialize = NULL;
+    cbInit.pfnMutexLock = NULL;
+    cbInit.pfnMutexRelease = NULL;
+
+    for (uint32_t nCopy : { LIBCB_FLAG_COPYMEMCPY, LIBCB_FLAG_COPYAUTO, LIBCB_FLAG_COPYAVX2, LIBCB_FLAG_COPYAVX512, LIBCB_FLAG_COPYSTREAM })
+    {
+        for (uint32_t nFlags : { LIBCB_FLAG_NONE, LIBCB_FLAG_SPSC })
+        {
+
+            status = circularBufferInitializeWithFlags(&cb, cbInit, nFlags | nCopy);
+
+            if (status == LIBCB_NOTSUPPORTED)
+            {
+                EXPECT_TRUE(nCopy == LIBCB_FLAG_COPYAVX2 || nCopy == LIBCB_FLAG_COPYAVX512 || nCopy == LIBCB_FLAG_COPYSTREAM);
+                continue;
+            }
+
+            ASSERT_EQ(status, LIBCB_SUCCESS);
+
+            // only the copy into the storage streams, a pop keeps the caller's data cached
+            EXPECT_EQ(cb.pfnCopyOut == cb.pfnCopy, nCopy != LIBCB_FLAG_COPYAUTO && nCopy != LIBCB_FLAG_COPYSTREAM);
+
+            // move the indexes so the payload is split at the end of the storage
+            EXPECT_EQ(circularBufferPush(&cb, data.data(), 1001), LIBCB_SUCCESS);
+            EXPECT_EQ(circularBufferPop(&cb, result.data(), 1001), LIBCB_SUCCESS);
+
+            EXPECT_EQ(circularBufferPush(&cb, data.data(), size), LIBCB_SUCCESS);
+            EXPECT_EQ(circularBufferPop(&cb, result.data(), size), LIBCB_SUCCESS);
+            EXPECT_EQ(memcmp(result.data(), data.data(), size), 0);
+
+            // the same through a kernel chosen for the call only
+            memset(result.data(), 0, size);
+
+            EXPECT_EQ(circularBufferPushCopy(&cb, data.data(), size, nCopy), LIBCB_SUCCESS);
+            EXPECT_EQ(circularBufferPopCopy(&cb, result.data(), size, nCopy), LIBCB_SUCCESS);
+            EXPECT_EQ(memcmp(result.data(), data.data(), size), 0);
+
+            EXPECT_EQ(circularBufferPushCopy(&cb, data.data(), 1, 0x00005000u), LIBCB_INVALIDPARAM);
+            EXPECT_EQ(circularBufferGetCount(&cb), 0);
+
+            circularBufferDeinitialize(&cb);
+        }
+    }
+
+
+    EXPECT_EQ(circularBufferInitializeWithFlags(&cb, cbInit, 0x00007000u), LIBCB_INVALIDPARAM);
+}
+
+TEST(CircularBufferExt, TestFind)
+{
+    // store two lines that wrap around the end of the buffer
+    // delimiters and patterns should be found in place, also when split at the wrap point
+
+    int32_t status;
+    uint8_t buffer[16], data[16] = {};
+    CircularBuffer cb;
+    CircularBufferInit cbInit;
+
+    cbInit.pBuffer = buffer;
+    cbInit.nBufferSize = sizeof(buffer);
+    cbInit.pfnMutexInitialize = NULL;
+    cbInit.pfnMutexLock = NULL;
+    cbInit.pfnMutexRelease = NULL;
+
+    for (uint32_t nFlags : { LIBCB_FLAG_NONE, LIBCB_FLAG_SPSC })
+    {
+
+        status = circularBufferInitializeWithFlags(&cb, cbInit, nFlags);
+
+        ASSERT_EQ(status, LIBCB_SUCCESS);
+
+        EXPECT_EQ(circularBufferFind(&cb, '\n', 0), LIBCB_BUFFEREMPTY);
+
+        // the "\r\n" of the first line is split at the end of the storage
+        EXPECT_EQ(circularBufferPush(&cb, data, 10), LIBCB_SUCCESS);
+        EXPECT_EQ(circularBufferPop(&cb, data, 10), LIBCB_SUCCESS);
+        EXPECT_EQ(circularBufferPush(&cb, (void *)"abcde\r\nxy\r\nz", 12), LIBCB_SUCCESS);
+
+        EXPECT_EQ(circularBufferFind(&cb, '\n', 0), 6);
+        EXPECT_EQ(circularBufferFind(&cb, '\n', 7), 10);
+        EXPECT_EQ(circularBufferFind(&cb, '\n', 11), LIBCB_NOTFOUND);
+        EXPECT_EQ(circularBufferFind(&cb, 'z', 12), LIBCB_NOTFOUND);
+        EXPECT_EQ(circularBufferFind(&cb, 'z', 13), LIBCB_BUFFERUNDERFLOW);
+
+        EXPECT_EQ(circularBufferFindPattern(&cb, "\r\n", 2, 0), 5);
+        EXPECT_EQ(circularBufferFindPattern(&cb, "\r\n", 2, 6), 9);
+        EXPECT_EQ(circularBufferFindPattern(&cb, "e\r\nx", 4, 0), 4);
+        EXPECT_EQ(circularBufferFindPattern(&cb, "\r\nz", 3, 0), 9);
+        EXPECT_EQ(circularBufferFindPattern(&cb, "\r\nzz", 4, 0), LIBCB_NOTFOUND);
+        EXPECT_EQ(circularBufferFindPattern(&cb, "\r\n", 0, 0), LIBCB_INVALIDPARAM);
+
+        // the search does not consume anything
+        EXPECT_EQ(circularBufferGetCount(&cb), 12);
+
+        circularBufferDeinitialize(&cb);
+    }
+}
+
+TEST(CircularBufferExt, TestCrc)
+{
+    // push wrapping data with a running CRC and records with a CRC each
+    // the CRCs should match a one-shot CRC of the same bytes and a damaged record should be reported
+
+    int32_t status;
+    uint8_t buffer[64], data[48], result[48];
+    uint32_t crc, size;
+    CircularBuffer cb;
+    CircularBufferInit cbInit;
+
+    for (uint32_t i = 0; i < sizeof(data); i++)
+    {
+        data[i] = (uint8_t)(i * 13 + 1);
+    }
+
+    // check value of the CRC32C (Castagnoli) catalogue
+    EXPECT_EQ(circularBufferCrc32c(0, "123456789", 9), 0xE3069283u);
+    EXPECT_EQ(circularBufferCrc32c(circularBufferCrc32c(0, "12345", 5), "6789", 4), 0xE3069283u);
+
+    cbInit.pBuffer = buffer;
+    cbInit.nBufferSize = sizeof(buffer);
+    cbInit.pfnMutexInitialize = NULL;
+    cbInit.pfnMutexLock = NULL;
+    cbInit.pfnMutexRelease = NULL;
+
+    for (uint32_t nFlags : { LIBCB_FLAG_NONE, LIBCB_FLAG_SPSC })
+    {
+
+        status = circularBufferInitializeWithFlags(&cb, cbInit, nFlags | LIBCB_FLAG_CRC);
+
+        ASSERT_EQ(status, LIBCB_SUCCESS);
+
+        EXPECT_EQ(circularBufferPush(&cb, data, 40), LIBCB_SUCCESS);
+        EXPECT_EQ(circularBufferGetPushedCrc(&cb, &crc, TRUE), LIBCB_SUCCESS);
+        EXPECT_EQ(crc, circularBufferCrc32c(0, data, 40));
+        EXPECT_EQ(circularBufferPop(&cb, result, 40), LIBCB_SUCCESS);
+
+        // both pushes wrap around the end of the storage
+        EXPECT_EQ(circularBufferPush(&cb, data, 30), LIBCB_SUCCESS);
+        EXPECT_EQ(circularBufferPush(&cb, data + 30, 18), LIBCB_SUCCESS);
+        EXPECT_EQ(circularBufferGetPushedCrc(&cb, &crc, FALSE), LIBCB_SUCCESS);
+        EXPECT_EQ(crc, circularBufferCrc32c(0, data, sizeof(data)));
+
+        // any stored range, across the wrap point as well
+        EXPECT_EQ(circularBufferCrc(&cb, 0, sizeof(data), &crc), LIBCB_SUCCESS);
+        EXPECT_EQ(crc, circularBufferCrc32c(0, data, sizeof(data)));
+        EXPECT_EQ(circularBufferCrc(&cb, 10, 30, &crc), LIBCB_SUCCESS);
+        EXPECT_EQ(crc, circularBufferCrc32c(0, data + 10, 30));
+        EXPECT_EQ(circularBufferCrc(&cb, 10, 39, &crc), LIBCB_BUFFERUNDERFLOW);
+
+        // every way into the stream counts, a failed or empty one does not
+        CircularBufferSpan spans[2], sources[2] = { { data + 15, 5 }, { data + 20, 60 } };
+
+        EXPECT_EQ(circularBufferGetPushedCrc(&cb, &crc, TRUE), LIBCB_SUCCESS);
+        EXPECT_EQ(circularBufferPop(&cb, result, sizeof(data)), LIBCB_SUCCESS);
+        EXPECT_EQ(circularBufferPushPartial(&cb, data, 10), 10);
+        EXPECT_EQ(circularBufferReserve(&cb, 8, spans), LIBCB_SUCCESS);
+        memcpy(spans[0].pData, data + 10, spans[0].nSize);
+        memcpy(spans[1].pData, data + 10 + spans[0].nSize, spans[1].nSize);
+        EXPECT_EQ(circularBufferCommit(&cb, 5), LIBCB_SUCCESS);
+        EXPECT_EQ(circularBufferPushv(&cb, sources, 2, LIBCB_BATCH_ALLORNOTHING), LIBCB_BUFFEROVERFLOW);
+        EXPECT_EQ(circularBufferPushv(&cb, sources, 2, LIBCB_BATCH_PARTIAL), 1);
+        EXPECT_EQ(circularBufferGetPushedCrc(&cb, &crc, FALSE), LIBCB_SUCCESS);
+        EXPECT_EQ(crc, circularBufferCrc32c(0, data, 20));
+
+        circularBufferDeinitialize(&cb);
+
+
+        status = circularBufferInitializeWithFlags(&cb, cbInit, nFlags | LIBCB_FLAG_RECORD | LIBCB_FLAG_RECORDCRC);
+
+        ASSERT_EQ(status, LIBCB_SUCCESS);
+
+        EXPECT_EQ(circularBufferPushRecord(&cb, data, 20), LIBCB_SUCCESS);
+        EXPECT_EQ(circularBufferGetNextRecordSize(&cb), 20);
+        EXPECT_EQ(circularBufferPopRecord(&cb, result, sizeof(result), &size), LIBCB_SUCCESS);
+        EXPECT_EQ(size, 20u);
+
+        // the header, payload and CRC of this record are split at the end of the storage
+        EXPECT_EQ(circularBufferPushRecord(&cb, data, 32), LIBCB_SUCCESS);
+        EXPECT_EQ(circularBufferGetCount(&cb), LIBCB_RECORD_HEADER_SIZE + 32 + LIBCB_RECORD_CRC_SIZE);
+        EXPECT_EQ(circularBufferPopRecord(&cb, result, sizeof(result), &size), LIBCB_SUCCESS);
+        EXPECT_EQ(size, 32u);
+        EXPECT_EQ(memcmp(result, data, 32), 0);
+
+        // a damaged payload is reported, the record is gone afterwards
+        EXPECT_EQ(circularBufferPushRecord(&cb, data, 8), LIBCB_SUCCESS);
+        buffer[(20 + 32 + 2 * (LIBCB_RECORD_HEADER_SIZE + LIBCB_RECORD_CRC_SIZE) + LIBCB_RECORD_HEADER_SIZE + 3) % sizeof(buffer)] ^= 0x01;
+        EXPECT_EQ(circularBufferPopRecord(&cb, result, sizeof(result), &size), LIBCB_CHECKSUMERROR);
+        EXPECT_EQ(size, 8u);
+        EXPECT_EQ(circularBufferGetCount(&cb), 0);
+
+        circularBufferDeinitialize(&cb);
+    }
+
+
+    EXPECT_EQ(circularBufferInitializeWithFlags(&cb, cbInit, LIBCB_FLAG_RECORDCRC), LIBCB_INVALIDPARAM);
+
+    // a buffer that cannot hold the header, the trailer and one byte is refused
+    cbInit.nBufferSize = LIBCB_RECORD_HEADER_SIZE + LIBCB_RECORD_CRC_SIZE;
+
+    EXPECT_EQ(circularBufferInitializeWithFlags(&cb, cbInit, LIBCB_FLAG_RECORD | LIBCB_FLAG_RECORDCRC), LIBCB_INVALIDPARAM);
+    EXPECT_EQ(circularBufferInitializeWithFlags(&cb, cbInit, LIBCB_FLAG_RECORD), LIBCB_INVALIDPARAM);
+
+    cbInit.nBufferSize++;
+
+    ASSERT_EQ(circularBufferInitializeWithFlags(&cb, cbInit, LIBCB_FLAG_RECORD | LIBCB_FLAG_RECORDCRC), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferPushRecord(&cb, data, 2), LIBCB_BUFFEROVERFLOW);
+    EXPECT_EQ(circularBufferPushRecord(&cb, data, 1), LIBCB_SUCCESS);
+
+    circularBufferDeinitialize(&cb);
+}
+
+TEST(CircularBufferExt, TestResize)
+{
+    // move wrapped data and records to storage of other sizes, then let a policy grow and shrink the buffer
+    // the data should come out in order and every storage left behind should be freed
+
+    int32_t status;
+    uint8_t buffer[16], larger[32], smaller[8], data[64], result[64];
+    uint32_t size;
+    void *oldBuffer = NULL;
+    CircularBuffer cb;
+    CircularBufferInit cbInit;
+
+    for (uint32_t i = 0; i < sizeof(data); i++)
+    {
+        data[i] = (uint8_t)(i * 7 + 3);
+    }
+
+    cbInit.pBuffer = buffer;
+    cbInit.nBufferSize = sizeof(buffer);
+    cbInit.pfnMutexInitialize = NULL;
+    cbInit.pfnMutexLock = NULL;
+    cbInit.pfnMutexRelease = NULL;
+
+    status = circularBufferInitialize(&cb, cbInit);
+
+    ASSERT_EQ(status, LIBCB_SUCCESS);
+
+    // the second push wraps around the end of the storage
+    EXPECT_EQ(circularBufferPush(&cb, data, 12), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferPop(&cb, result, 8), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferPush(&cb, data + 12, 10), LIBCB_SUCCESS);
+
+    EXPECT_EQ(circularBufferResize(&cb, smaller, sizeof(smaller), &oldBuffer), LIBCB_BUFFEROVERFLOW);
+    EXPECT_EQ(circularBufferResize(&cb, larger, sizeof(larger), &oldBuffer), LIBCB_SUCCESS);
+    EXPECT_EQ(oldBuffer, (void *)buffer);
+    EXPECT_EQ(circularBufferGetCapacity(&cb), (int32_t)sizeof(larger));
+    EXPECT_EQ(memcmp(larger, data + 8, 14), 0);
+
+    EXPECT_EQ(circularBufferPush(&cb, data + 22, 18), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferPop(&cb, result, 30), LIBCB_SUCCESS);
+    EXPECT_EQ(memcmp(result, data + 8, 30), 0);
+
+    EXPECT_EQ(circularBufferResize(&cb, smaller, sizeof(smaller), NULL), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferPop(&cb, result, 2), LIBCB_SUCCESS);
+    EXPECT_EQ(memcmp(result, data + 38, 2), 0);
+
+    circularBufferDeinitialize(&cb);
+
+    // the padding in front of a wrapped record is dropped by the move
+    cbInit.pBuffer = larger;
+    cbInit.nBufferSize = sizeof(larger);
+
+    ASSERT_EQ(circularBufferInitializeWithFlags(&cb, cbInit, LIBCB_FLAG_RECORD | LIBCB_FLAG_RECORDNOWRAP), LIBCB_SUCCESS);
+
+    EXPECT_EQ(circularBufferPushRecord(&cb, data, 10), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferPushRecord(&cb, data + 10, 10), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferPopRecord(&cb, result, sizeof(result), &size), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferPushRecord(&cb, data + 20, 10), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferGetCount(&cb), 32);
+
+    uint8_t packed[2 * (LIBCB_RECORD_HEADER_SIZE + 10)];
+
+    EXPECT_EQ(circularBufferResize(&cb, packed, sizeof(packed), NULL), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferGetCount(&cb), (int32_t)sizeof(packed));
+    EXPECT_EQ(circularBufferPopRecord(&cb, result, sizeof(result), &size), LIBCB_SUCCESS);
+    EXPECT_EQ(memcmp(result, data + 10, size), 0);
+    EXPECT_EQ(circularBufferPopRecord(&cb, result, sizeof(result), &size), LIBCB_SUCCESS);
+    EXPECT_EQ(memcmp(result, data + 20, size), 0);
+
+    circularBufferDeinitialize(&cb);
+
+    cbInit.pBuffer = buffer;
+    cbInit.nBufferSize = sizeof(buffer);
+
+    ASSERT_EQ(circularBufferInitializeWithFlags(&cb, cbInit, LIBCB_FLAG_POWEROFTWO), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferResize(&cb, data, 24, NULL), LIBCB_INVALIDPARAM);
+    circularBufferDeinitialize(&cb);
+
+
+    ASSERT_EQ(circularBufferInitializeWithFlags(&cb, cbInit, LIBCB_FLAG_SPSC), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferResize(&cb, larger, sizeof(larger), NULL), LIBCB_NOTSUPPORTED);
+    circularBufferDeinitialize(&cb);
+
+    // the policy owns every storage, the first one included
+    struct Heap
+    {
+        int32_t nLive;
+    } heap = { 1 };
+
+    CircularBufferResizePolicy policy;
+
+    policy.pfnAllocate = [](uint32_t nSize, void *pContext) -> void * {
+        static_cast<Heap *>(pContext)->nLive++;
+        return malloc(nSize);
+    };
+    policy.pfnFree = [](void *pBuffer, uint32_t, void *pContext) {
+        static_cast<Heap *>(pContext)->nLive--;
+        free(pBuffer);
+    };
+    policy.pContext = &heap;
+    policy.nMaxSize = 64;
+    policy.nMinSize = 16;
+    policy.nShrinkAfter = 4;
+
+    cbInit.pBuffer = malloc(16);
+    cbInit.nBufferSize = 16;
+
+    ASSERT_EQ(circularBufferInitializeWithFlags(&cb, cbInit, LIBCB_FLAG_POWEROFTWO), LIBCB_SUCCESS);
+    ASSERT_EQ(circularBufferSetResizePolicy(&cb, &policy), LIBCB_SUCCESS);
+
+    // grows 16, 32, 64 and stops at the ceiling
+    EXPECT_EQ(circularBufferPush(&cb, data, 12), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferPop(&cb, result, 8), LIBCB_SUCCESS);
+
+    for (uint32_t i = 12; i < sizeof(data); i += 13)
+    {
+        EXPECT_EQ(circularBufferPush(&cb, data + i, i + 13 <= sizeof(data) ? 13 : sizeof(data) - i), LIBCB_SUCCESS);
+    }
+
+    EXPECT_EQ(circularBufferGetCapacity(&cb), 64);
+    EXPECT_EQ(circularBufferPush(&cb, data, 9), LIBCB_BUFFEROVERFLOW);
+    EXPECT_EQ(heap.nLive, 1);
+
+    EXPECT_EQ(circularBufferPop(&cb, result, 56), LIBCB_SUCCESS);
+    EXPECT_EQ(memcmp(result, data + 8, 56), 0);
+
+    // the peak of 56 bytes keeps the size for the next checks, low use halves it down to the floor
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        EXPECT_EQ(circularBufferPush(&cb, data + i, 1), LIBCB_SUCCESS);
+        EXPECT_EQ(circularBufferPush(&cb, data + i + 1, 1), LIBCB_SUCCESS);
+        EXPECT_EQ(circularBufferPop(&cb, result, 2), LIBCB_SUCCESS);
+        EXPECT_EQ(memcmp(result, data + i, 2), 0);
+    }
+
+    EXPECT_EQ(circularBufferGetCapacity(&cb), 16);
+    EXPECT_EQ(heap.nLive, 1);
+
+    // a reservation grows the storage like a push
+    CircularBufferSpan spans[2];
+
+    EXPECT_EQ(circularBufferReserve(&cb, 40, spans), LIBCB_SUCCESS);
+    EXPECT_EQ(spans[0].nSize + spans[1].nSize, 40u);
+    EXPECT_EQ(circularBufferCommit(&cb, 0), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferGetCapacity(&cb), 64);
+    EXPECT_EQ(heap.nLive, 1);
+
+    // partial pops, consumes and batches count towards the shrink as well
+    for (uint32_t i = 0; i < 12; i++)
+    {
+        CircularBufferSpan destination = { result, 2 };
+
+        EXPECT_EQ(circularBufferPush(&cb, data + i, 2), LIBCB_SUCCESS);
+
+        if (i % 3 == 0)
+        {
+            EXPECT_EQ(circularBufferPopPartial(&cb, result, 8), 2);
+        }
+        else if (i % 3 == 1)
+        {
+            EXPECT_EQ(circularBufferPeek(&cb, spans), LIBCB_SUCCESS);
+            memcpy(result, spans[0].pData, 2);
+            EXPECT_EQ(circularBufferConsume(&cb, 2), LIBCB_SUCCESS);
+        }
+        else
+        {
+            EXPECT_EQ(circularBufferPopv(&cb, &destination, 1, LIBCB_BATCH_ALLORNOTHING), 1);
+        }
+
+        EXPECT_EQ(memcmp(result, data + i, 2), 0);
+    }
+
+    EXPECT_EQ(circularBufferGetCapacity(&cb), 16);
+    EXPECT_EQ(heap.nLive, 1);
+
+    policy.nMaxSize = 48;
+
+    EXPECT_EQ(circularBufferSetResizePolicy(&cb, &policy), LIBCB_INVALIDPARAM);
+
+    void *storage = cb.init.pBuffer;
+
+    circularBufferDeinitialize(&cb);
+    free(storage);
+}
+
+TEST(CircularBufferExt, TestResizeConcurrent)
+{
+    // resize a locked circular buffer back and forth while a producer and a consumer stream through it
+    // every byte should arrive in order and the capacity should only ever read as one of the two sizes
+
+    const uint32_t total = 200000;
+    uint8_t first[128], second[128];
+    CircularBufferInit cbInit;
+    CircularBuffer cb;
+    uint32_t badCapacity = 0, mismatches = 0;
+    bool done = false;
+
+    cbInit.pBuffer = first;
+    cbInit.nBufferSize = sizeof(first);
+    cbInit.pfnMutexInitialize = NULL;
+    cbInit.pfnMutexLock = NULL;
+    cbInit.pfnMutexRelease = NULL;
+
+    ASSERT_EQ(circularBufferInitializeWithFlags(&cb, cbInit, LIBCB_FLAG_LOCKTTAS), LIBCB_SUCCESS);
+
+    std::thread producer([&cb, total]() {
+        for (uint32_t sent = 0; sent < total; )
+        {
+            uint8_t chunk[7];
+            uint32_t size = total - sent < sizeof(chunk) ? total - sent : (uint32_t)sizeof(chunk);
+
+            for (uint32_t i = 0; i < size; i++)
+            {
+                chunk[i] = (uint8_t)(sent + i);
+            }
+
+            if (circularBufferPush(&cb, chunk, size) == LIBCB_SUCCESS)
+            {
+                sent += size;
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    std::thread resizer([&cb, &second, &done]() {
+        void *spare = second;
+        uint32_t size = 64;
+
+        while (!__atomic_load_n(&done, __ATOMIC_ACQUIRE))
+        {
+            if (circularBufferResize(&cb, spare, size, &spare) == LIBCB_SUCCESS)
+            {
+                size = size == 64 ? 128 : 64;
+            }
+
+            std::this_thread::yield();
+        }
+    });
+
+    for (uint32_t received = 0; received < total; )
+    {
+        uint8_t value;
+        int32_t capacity = circularBufferGetCapacity(&cb);
+
+        badCapacity += capacity != 64 && capacity != 128;
+
+        if (circularBufferPop(&cb, &value, 1) == LIBCB_SUCCESS)
+        {
+            mismatches += value != (uint8_t)received;
+            received++;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    __atomic_store_n(&done, true, __ATOMIC_RELEASE);
+    producer.join();
+    resizer.join();
+
+    EXPECT_EQ(badCapacity, 0u);
+    EXPECT_EQ(mismatches, 0u);
+    EXPECT_EQ(circularBufferDeinitialize(&cb), LIBCB_SUCCESS);
+}
@@ -0,0 +1,198 @@
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include "gtest/gtest.h"
+#include "libCircularBuffer/CircularBufferFile.h"
+
+// path of a scratch file that is unique to this process
+static std::string scratchPath(const char *tag)
+{
+    return "/tmp/libcb-" + std::string(tag) + "-" + std::to_string(getpid());
+}
+
+TEST(CircularBufferFile, TestReopen)
+{
+    // push bytes, close the file and open it again
+    // the indexes should come back from the header and the data should survive
+
+    int32_t status;
+    uint8_t data[100], result[100];
+    std::string path = scratchPath("reopen");
+    CircularBufferFile ring;
+
+    unlink(path.c_str());
+
+    status = circularBufferFileOpen(&ring, path.c_str(), 100, LIBCB_FILE_FLAG_NONE, LIBCB_FILE_SYNC_ALWAYS);
+
+    ASSERT_EQ(status, LIBCB_SUCCESS);
+    EXPECT_EQ(ring.pHeader->nBufferSize, 128u);
+
+    for (uint32_t i = 0; i < sizeof(data); i++)
+    {
+        data[i] = (uint8_t)i;
+    }
+
+    // move the indexes so the stored bytes wrap around the end of the storage
+    EXPECT_EQ(circularBufferFilePush(&ring, data, 60), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferFilePop(&ring, result, 60), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferFilePush(&ring, data, sizeof(data)), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferFilePush(&ring, data, sizeof(data)), LIBCB_BUFFEROVERFLOW);
+
+    uint64_t generation = ring.pHeader->nGeneration;
+
+    EXPECT_EQ(circularBufferFileClose(&ring), LIBCB_SUCCESS);
+
+    // size and mode of an existing file are taken from its header
+    status = circularBufferFileOpen(&ring, path.c_str(), 4096, LIBCB_FILE_FLAG_RECORD, LIBCB_FILE_SYNC_NONE);
+
+    ASSERT_EQ(status, LIBCB_SUCCESS);
+    EXPECT_EQ(ring.pHeader->nBufferSize, 128u);
+    EXPECT_EQ(ring.pHeader->nFlags, LIBCB_FILE_FLAG_NONE);
+    EXPECT_GT(ring.pHeader->nGeneration, generation);
+    EXPECT_EQ(circularBufferFileGetCount(&ring), (int32_t)sizeof(data));
+    EXPECT_EQ(circularBufferFilePop(&ring, result, sizeof(result)), LIBCB_SUCCESS);
+    EXPECT_EQ(memcmp(result, data, sizeof(data)), 0);
+    EXPECT_EQ(circularBufferFilePop(&ring, result, 1), LIBCB_BUFFEREMPTY);
+
+    EXPECT_EQ(circularBufferFileClose(&ring), LIBCB_SUCCESS);
+
+    // a file that is not a circular buffer is rejected
+    EXPECT_EQ(truncate(path.c_str(), 16), 0);
+    EXPECT_EQ(circularBufferFileOpen(&ring, path.c_str(), 100, LIBCB_FILE_FLAG_NONE, LIBCB_FILE_SYNC_NONE), LIBCB_INVALIDPARAM);
+
+    unlink(path.c_str());
+}
+
+TEST(CircularBufferFile, TestTornRecord)
+{
+    // store records, then damage the newest one as if its data never reached the disk
+    // reopening should drop only that record and keep the older ones
+
+    int32_t status;
+    uint32_t size;
+    char result[64];
+    std::string path = scratchPath("torn");
+    CircularBufferFile ring;
+
+    unlink(path.c_str());
+
+    status = circularBufferFileOpen(&ring, path.c_str(), 64, LIBCB_FILE_FLAG_RECORD, LIBCB_FILE_SYNC_ASYNC);
+
+    ASSERT_EQ(status, LIBCB_SUCCESS);
+
+    // wrap the records around the end of the storage
+    EXPECT_EQ(circularBufferFilePushRecord(&ring, "0123456789012345678901234567890123456789", 40), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferFilePopRecord(&ring, result, sizeof(result), &size), LIBCB_SUCCESS);
+    EXPECT_EQ(size, 40u);
+
+    EXPECT_EQ(circularBufferFilePushRecord(&ring, "first", 5), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferFilePushRecord(&ring, "second record", 13), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferFilePushRecord(&ring, "third record", 12), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferFilePushRecord(&ring, "too long for the rest", 21), LIBCB_BUFFEROVERFLOW);
+
+    // a record that fits is never dropped on open
+    EXPECT_EQ(circularBufferFileClose(&ring), LIBCB_SUCCESS);
+    ASSERT_EQ(circularBufferFileOpen(&ring, path.c_str(), 0, LIBCB_FILE_FLAG_RECORD, LIBCB_FILE_SYNC_ASYNC), LIBCB_SUCCESS);
+    EXPECT_EQ(ring.nDiscarded, 0u);
+    EXPECT_EQ(circularBufferFileGetCount(&ring), 3 * LIBCB_FILE_RECORD_HEADER_SIZE + 5 + 13 + 12);
+
+    // flip a payload byte of the newest record
+    uint32_t last = ring.pHeader->nLastRecord + LIBCB_FILE_RECORD_HEADER_SIZE + 1;
+
+    ring.pData[last & (ring.pHeader->nBufferSize - 1)] ^= 0xFF;
+
+    EXPECT_EQ(circularBufferFileClose(&ring), LIBCB_SUCCESS);
+    ASSERT_EQ(circularBufferFileOpen(&ring, path.c_str(), 0, LIBCB_FILE_FLAG_RECORD, LIBCB_FILE_SYNC_ASYNC), LIBCB_SUCCESS);
+    EXPECT_EQ(ring.nDiscarded, (uint32_t)LIBCB_FILE_RECORD_HEADER_SIZE + 12);
+
+    EXPECT_EQ(circularBufferFilePopRecord(&ring, result, 4, &size), LIBCB_BUFFEROVERFLOW);
+    EXPECT_EQ(size, 5u);
+    EXPECT_EQ(circularBufferFilePopRecord(&ring, result, sizeof(result), &size), LIBCB_SUCCESS);
+    EXPECT_EQ(memcmp(result, "first", 5), 0);
+    EXPECT_EQ(circularBufferFilePopRecord(&ring, result, sizeof(result), &size), LIBCB_SUCCESS);
+    EXPECT_EQ(memcmp(result, "second record", 13), 0);
+    EXPECT_EQ(circularBufferFilePopRecord(&ring, result, sizeof(result), &size), LIBCB_BUFFEREMPTY);
+
+    // the position of the record before the dropped one is unknown, nothing more is dropped
+    EXPECT_EQ(circularBufferFilePushRecord(&ring, "fourth", 6), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferFileClose(&ring), LIBCB_SUCCESS);
+    ASSERT_EQ(circularBufferFileOpen(&ring, path.c_str(), 0, LIBCB_FILE_FLAG_RECORD, LIBCB_FILE_SYNC_NONE), LIBCB_SUCCESS);
+    EXPECT_EQ(ring.nDiscarded, 0u);
+    EXPECT_EQ(circularBufferFilePopRecord(&ring, result, sizeof(result), &size), LIBCB_SUCCESS);
+    EXPECT_EQ(memcmp(result, "fourth", 6), 0);
+
+    EXPECT_EQ(circularBufferFileClose(&ring), LIBCB_SUCCESS);
+
+    unlink(path.c_str());
+}
+
+TEST(CircularBufferFile, TestUnformattedFile)
+{
+    // leave files behind as if their creator died after sizing them, before the header reached the disk
+    // opening them should format them instead of rejecting them forever
+
+    std::string path = scratchPath("unformatted");
+    CircularBufferFile ring;
+    uint8_t result[4];
+
+    unlink(path.c_str());
+
+    int fd = open(path.c_str(), O_RDWR | O_CREAT, 0600);
+
+    ASSERT_GE(fd, 0);
+    EXPECT_EQ(ftruncate(fd, 8192), 0);
+
+    // only some header fields made it, the magic did not
+    uint32_t fields[4] = { 0, LIBCB_FILE_VERSION, 4096, LIBCB_FILE_FLAG_NONE };
+
+    EXPECT_EQ(pwrite(fd, fields, sizeof(fields), 0), (ssize_t)sizeof(fields));
+    close(fd);
+
+    ASSERT_EQ(circularBufferFileOpen(&ring, path.c_str(), 64, LIBCB_FILE_FLAG_RECORD, LIBCB_FILE_SYNC_NONE), LIBCB_SUCCESS);
+    EXPECT_EQ(ring.pHeader->nBufferSize, 64u);
+    EXPECT_EQ(ring.pHeader->nFlags, LIBCB_FILE_FLAG_RECORD);
+    EXPECT_EQ(circularBufferFileGetCount(&ring), 0);
+    EXPECT_EQ(circularBufferFilePushRecord(&ring, "data", 4), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferFileClose(&ring), LIBCB_SUCCESS);
+
+    ASSERT_EQ(circularBufferFileOpen(&ring, path.c_str(), 0, LIBCB_FILE_FLAG_NONE, LIBCB_FILE_SYNC_NONE), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferFilePopRecord(&ring, result, sizeof(result), NULL), LIBCB_SUCCESS);
+    EXPECT_EQ(memcmp(result, "data", 4), 0);
+    EXPECT_EQ(circularBufferFileClose(&ring), LIBCB_SUCCESS);
+
+    unlink(path.c_str());
+}
+
+TEST(CircularBufferFile, TestOpenWhileInUse)
+{
+    // hold the spinlock and a torn looking record through one handle, then open a second one
+    // the second open should leave both alone, only an open without other handles repairs them
+
+    std::string path = scratchPath("inuse");
+    CircularBufferFile first, second;
+
+    unlink(path.c_str());
+
+    ASSERT_EQ(circularBufferFileOpen(&first, path.c_str(), 64, LIBCB_FILE_FLAG_RECORD, LIBCB_FILE_SYNC_NONE), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferFilePushRecord(&first, "record", 6), LIBCB_SUCCESS);
+
+    first.pData[(first.pHeader->nLastRecord + LIBCB_FILE_RECORD_HEADER_SIZE) & (first.pHeader->nBufferSize - 1)] ^= 0xFF;
+    first.pHeader->nLockWord = 1;
+
+    ASSERT_EQ(circularBufferFileOpen(&second, path.c_str(), 0, LIBCB_FILE_FLAG_RECORD, LIBCB_FILE_SYNC_NONE), LIBCB_SUCCESS);
+    EXPECT_EQ(second.pHeader->nLockWord, 1u);
+    EXPECT_EQ(second.nDiscarded, 0u);
+    EXPECT_EQ(circularBufferFileClose(&second), LIBCB_SUCCESS);
+
+    // the first handle dies holding the lock, the next open is alone with the file
+    EXPECT_EQ(circularBufferFileClose(&first), LIBCB_SUCCESS);
+
+    ASSERT_EQ(circularBufferFileOpen(&second, path.c_str(), 0, LIBCB_FILE_FLAG_RECORD, LIBCB_FILE_SYNC_NONE), LIBCB_SUCCESS);
+    EXPECT_EQ(second.pHeader->nLockWord, 0u);
+    EXPECT_EQ(second.nDiscarded, (uint32_t)LIBCB_FILE_RECORD_HEADER_SIZE + 6);
+    EXPECT_EQ(circularBufferFileGetCount(&second), 0);
+    EXPECT_EQ(circularBufferFileClose(&second), LIBCB_SUCCESS);
+
+    unlink(path.c_str());
+}
@@ -0,0 +1,175 @@
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "libCircularBuffer/CircularBufferGroup.h"
+
+TEST(CircularBufferGroup, TestSteal)
+{
+    // fill the rings of two of three producers
+    // a consumer should drain its home ring first and steal from the next ring once it is empty
+
+    int32_t status;
+    uint8_t buffer[3 * 128];
+    uint32_t size, ring;
+    char result[32];
+    CircularBufferGroupMember members[3];
+    CircularBufferGroup group;
+    CircularBufferGroupInit groupInit;
+
+    groupInit.pBuffer = buffer;
+    groupInit.nBufferSize = sizeof(buffer);
+    groupInit.aMembers = members;
+    groupInit.nRingCount = 3;
+    groupInit.nFlags = LIBCB_GROUP_FLAG_NONE;
+
+    status = circularBufferGroupInitialize(&group, groupInit);
+
+    ASSERT_EQ(status, LIBCB_SUCCESS);
+    EXPECT_EQ(group.nRingSize, 128u);
+
+    EXPECT_EQ(circularBufferGroupPush(&group, 0, "zero", 4), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferGroupPush(&group, 2, "two-a", 5), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferGroupPush(&group, 5, "two-b", 5), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferGroupGetCount(&group), 3 * LIBCB_RECORD_HEADER_SIZE + 14);
+
+    // the home ring of consumer 1 is empty, ring 2 is next in line
+    EXPECT_EQ(circularBufferGroupPop(&group, 1, result, sizeof(result), &size, &ring), LIBCB_SUCCESS);
+    EXPECT_EQ(ring, 2u);
+    EXPECT_EQ(memcmp(result, "two-a", size), 0);
+
+    EXPECT_EQ(circularBufferGroupPop(&group, 0, result, sizeof(result), &size, &ring), LIBCB_SUCCESS);
+    EXPECT_EQ(ring, 0u);
+    EXPECT_EQ(memcmp(result, "zero", size), 0);
+
+    EXPECT_EQ(circularBufferGroupPop(&group, 0, result, 2, &size, &ring), LIBCB_BUFFEROVERFLOW);
+
+    // a batch is stolen from one ring under one lock acquisition
+    EXPECT_EQ(circularBufferGroupPush(&group, 2, "two-c", 5), LIBCB_SUCCESS);
+
+    char first[8], second[8];
+    CircularBufferSpan spans[3] = { { first, sizeof(first) }, { second, sizeof(second) }, { result, sizeof(result) } };
+
+    EXPECT_EQ(circularBufferGroupPopv(&group, 0, spans, 3, &ring), 2);
+    EXPECT_EQ(ring, 2u);
+    EXPECT_EQ(spans[0].nSize, 5u);
+    EXPECT_EQ(memcmp(first, "two-b", 5), 0);
+    EXPECT_EQ(memcmp(second, "two-c", 5), 0);
+
+    EXPECT_EQ(circularBufferGroupPop(&group, 1, result, sizeof(result), &size, &ring), LIBCB_BUFFEREMPTY);
+    EXPECT_EQ(circularBufferGroupRelease(&group, 1, 2), LIBCB_INVALIDPARAM);
+
+    EXPECT_EQ(circularBufferGroupDeinitialize(&group), LIBCB_SUCCESS);
+
+    // every ring needs room for a record header
+    groupInit.nBufferSize = 3 * LIBCB_CACHELINE - 1;
+
+    EXPECT_EQ(circularBufferGroupInitialize(&group, groupInit), LIBCB_INVALIDPARAM);
+}
+
+TEST(CircularBufferGroup, TestFifoClaim)
+{
+    // consumers drain the rings of four producers concurrently with FIFO claims
+    // every record should arrive once and the records of a producer in order
+
+    const uint32_t producers = 4, consumers = 3, records = 2000;
+    std::vector<uint8_t> buffer(producers * 1024);
+    CircularBufferGroupMember members[producers];
+    CircularBufferGroup group;
+    CircularBufferGroupInit groupInit;
+    uint32_t received[producers] = {};
+    uint32_t outOfOrder = 0;
+
+    groupInit.pBuffer = buffer.data();
+    groupInit.nBufferSize = (uint32_t)buffer.size();
+    groupInit.aMembers = members;
+    groupInit.nRingCount = producers;
+    groupInit.nFlags = LIBCB_GROUP_FLAG_FIFO;
+
+    ASSERT_EQ(circularBufferGroupInitialize(&group, groupInit), LIBCB_SUCCESS);
+
+    std::vector<std::thread> threads;
+
+    for (uint32_t p = 0; p < producers; p++)
+    {
+        threads.emplace_back([&group, p]() {
+            for (uint32_t sequence = 0; sequence < records; )
+            {
+                uint32_t message[2] = { p, sequence };
+
+                if (circularBufferGroupPush(&group, p, message, sizeof(message)) == LIBCB_SUCCESS)
+                {
+                    sequence++;
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    for (uint32_t c = 0; c < consumers; c++)
+    {
+        threads.emplace_back([&group, &received, &outOfOrder, c]() {
+            uint32_t total;
+
+            do
+            {
+                uint32_t message[2], size, ring;
+
+                if (circularBufferGroupPop(&group, c, message, sizeof(message), &size, &ring) == LIBCB_SUCCESS)
+                {
+                    // the claim makes this consumer the only one touching the counter of the producer
+                    if (message[1] != __atomic_load_n(&received[message[0]], __ATOMIC_RELAXED))
+                    {
+                        __atomic_add_fetch(&outOfOrder, 1, __ATOMIC_RELAXED);
+                    }
+
+                    __atomic_store_n(&received[message[0]], message[1] + 1, __ATOMIC_RELAXED);
+                    circularBufferGroupRelease(&group, c, ring);
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+
+                total = 0;
+
+                for (uint32_t p = 0; p < producers; p++)
+                {
+                    total += __atomic_load_n(&received[p], __ATOMIC_RELAXED);
+                }
+            } while (total < producers * records);
+        });
+    }
+
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_EQ(outOfOrder, 0u);
+    EXPECT_EQ(circularBufferGroupGetCount(&group), 0);
+
+    // a claimed ring is skipped by the other consumers until it is released
+    uint32_t message = 7, size, ring;
+
+    EXPECT_EQ(circularBufferGroupPush(&group, 0, &message, sizeof(message)), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferGroupPush(&group, 0, &message, sizeof(message)), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferGroupPop(&group, 0, &message, sizeof(message), &size, &ring), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferGroupPop(&group, 3, &message, sizeof(message), &size, &ring), LIBCB_BUFFEREMPTY);
+
+    // the last consumer index would claim a ring with the free value
+    CircularBufferSpan span = { &message, sizeof(message) };
+
+    EXPECT_EQ(circularBufferGroupPop(&group, UINT32_MAX, &message, sizeof(message), &size, &ring), LIBCB_INVALIDPARAM);
+    EXPECT_EQ(circularBufferGroupPopv(&group, UINT32_MAX, &span, 1, &ring), LIBCB_INVALIDPARAM);
+    EXPECT_EQ(circularBufferGroupRelease(&group, UINT32_MAX, 0), LIBCB_INVALIDPARAM);
+
+    EXPECT_EQ(circularBufferGroupRelease(&group, 0, 0), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferGroupPop(&group, 3, &message, sizeof(message), &size, &ring), LIBCB_SUCCESS);
+    EXPECT_EQ(ring, 0u);
+
+    EXPECT_EQ(circularBufferGroupDeinitialize(&group), LIBCB_SUCCESS);
+}
@@ -0,0 +1,138 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "libCircularBuffer/CircularBufferMpmc.h"
+
+TEST(CircularBufferMpmc, TestPushPop)
+{
+    // create a multi-producer/multi-consumer circular buffer and fill every slot
+    // the next push should fail until an element is popped
+
+    int32_t status;
+    uint64_t buffer[64];
+    uint32_t value, size;
+    CircularBufferMpmcInit cbInit;
+    CircularBufferMpmc cb;
+
+    cbInit.pBuffer = buffer;
+    cbInit.nBufferSize = sizeof(buffer);
+    cbInit.nElementSize = sizeof(uint32_t);
+
+    status = circularBufferMpmcInitialize(&cb, cbInit);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+
+    // 512 bytes with 16 byte slots gives 32 slots
+    EXPECT_EQ(circularBufferMpmcGetCapacity(&cb), 32);
+
+    for (value = 0; value < 32; value++)
+    {
+        status = circularBufferMpmcPush(&cb, &value, sizeof(value));
+        EXPECT_EQ(status, LIBCB_SUCCESS);
+    }
+
+    EXPECT_EQ(circularBufferMpmcGetCount(&cb), 32);
+
+    status = circularBufferMpmcPush(&cb, &value, sizeof(value));
+
+    EXPECT_EQ(status, LIBCB_BUFFEROVERFLOW);
+
+    for (uint32_t i = 0; i < 32; i++)
+    {
+        status = circularBufferMpmcPop(&cb, &value, sizeof(value), &size);
+        EXPECT_EQ(status, LIBCB_SUCCESS);
+        EXPECT_EQ(value, i);
+        EXPECT_EQ(size, sizeof(value));
+    }
+
+    status = circularBufferMpmcPop(&cb, &value, sizeof(value), &size);
+
+    EXPECT_EQ(status, LIBCB_BUFFEREMPTY);
+
+    // an element size that wraps the slot size around is rejected before the storage is touched
+    cbInit.nBufferSize = UINT32_MAX;
+    cbInit.nElementSize = UINT32_MAX - 4;
+
+    EXPECT_EQ(circularBufferMpmcInitialize(&cb, cbInit), LIBCB_INVALIDPARAM);
+}
+
+TEST(CircularBufferMpmc, TestConcurrentProducersConsumers)
+{
+    // run several producers and consumers against a small circular buffer
+    // every element should be popped exactly once and in order per producer
+
+    const uint32_t producerCount = 8, consumerCount = 4, perProducer = 20000;
+    int32_t status;
+    uint64_t buffer[256];
+    CircularBufferMpmcInit cbInit;
+    CircularBufferMpmc cb;
+
+    cbInit.pBuffer = buffer;
+    cbInit.nBufferSize = sizeof(buffer);
+    cbInit.nElementSize = sizeof(uint32_t) * 2;
+
+    status = circularBufferMpmcInitialize(&cb, cbInit);
+
+    EXPECT_EQ(status, LIBCB_SUCCESS);
+
+    std::atomic<uint32_t> remaining(producerCount * perProducer);
+    std::atomic<uint32_t> outOfOrder(0);
+    std::vector<std::atomic<uint32_t>> seen(producerCount);
+    std::vector<std::thread> threads;
+
+    for (uint32_t p = 0; p < producerCount; p++)
+    {
+        threads.emplace_back([&cb, p, perProducer]() {
+            for (uint32_t i = 0; i < perProducer; i++)
+            {
+                uint32_t element[2] = { p, i };
+
+                while (circularBufferMpmcPush(&cb, element, sizeof(element)) != LIBCB_SUCCESS)
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    for (uint32_t c = 0; c < consumerCount; c++)
+    {
+        threads.emplace_back([&cb, &remaining, &outOfOrder, &seen, producerCount]() {
+            std::vector<int64_t> last(producerCount, -1);
+            uint32_t element[2];
+
+            while (remaining.load() > 0)
+            {
+                if (circularBufferMpmcPop(&cb, element, sizeof(element), NULL) != LIBCB_SUCCESS)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                if ((int64_t)element[1] <= last[element[0]])
+                {
+                    outOfOrder++;
+                }
+
+                last[element[0]] = element[1];
+                seen[element[0]]++;
+                remaining--;
+            }
+        });
+    }
+
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_EQ(outOfOrder.load(), 0u);
+
+    for (uint32_t p = 0; p < producerCount; p++)
+    {
+        EXPECT_EQ(seen[p].load(), perProducer);
+    }
+
+    EXPECT_EQ(circularBufferMpmcGetCount(&cb), 0);
+}
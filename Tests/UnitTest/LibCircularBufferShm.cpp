@@ -0,0 +1,212 @@
+#include <chrono>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "gtest/gtest.h"
+#include "libCircularBuffer/CircularBufferShm.h"
+
+// fill a chunk with a pattern that depends on the stream position
+static void fillChunk(uint8_t *chunk, uint32_t size, uint64_t position)
+{
+    for (uint32_t i = 0; i < size; i++)
+    {
+        chunk[i] = (uint8_t)((position + i) * 131);
+    }
+}
+
+TEST(CircularBufferShm, TestCreateAttach)
+{
+    // create a shared circular buffer and attach a second view to it
+    // data pushed through one view should be popped through the other
+
+    int32_t status;
+    uint8_t data[100], result[100];
+    std::string name = "/libcb-test-" + std::to_string(getpid());
+    CircularBufferShm producer, consumer;
+
+    status = circularBufferShmCreate(&producer, name.c_str(), 100, LIBCB_SHM_FLAG_NONE);
+
+    ASSERT_EQ(status, LIBCB_SUCCESS);
+    EXPECT_EQ(producer.pHeader->nBufferSize, 128u);
+
+    // the name is taken until it is unlinked
+    status = circularBufferShmCreate(&consumer, name.c_str(), 100, LIBCB_SHM_FLAG_NONE);
+
+    EXPECT_EQ(status, LIBCB_SYSTEMERROR);
+
+    status = circularBufferShmAttach(&consumer, name.c_str());
+
+    ASSERT_EQ(status, LIBCB_SUCCESS);
+    EXPECT_NE(consumer.pHeader, producer.pHeader);
+
+    fillChunk(data, sizeof(data), 0);
+
+    for (int lap = 0; lap < 5; lap++)
+    {
+        EXPECT_EQ(circularBufferShmPush(&producer, data, sizeof(data)), LIBCB_SUCCESS);
+        EXPECT_EQ(circularBufferShmPush(&producer, data, sizeof(data)), LIBCB_BUFFEROVERFLOW);
+        EXPECT_EQ(circularBufferShmGetCount(&consumer), (int32_t)sizeof(data));
+        EXPECT_EQ(circularBufferShmPop(&consumer, result, sizeof(result)), LIBCB_SUCCESS);
+        EXPECT_EQ(memcmp(result, data, sizeof(data)), 0);
+    }
+
+    EXPECT_EQ(circularBufferShmPop(&consumer, result, 1), LIBCB_BUFFEREMPTY);
+
+    EXPECT_EQ(circularBufferShmDetach(&consumer), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferShmDetach(&producer), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferShmUnlink(name.c_str()), LIBCB_SUCCESS);
+}
+
+TEST(CircularBufferShm, TestAttachAfterTraffic)
+{
+    // move the indexes of a lock-free shared ring away from 0, then attach a new view
+    // the new view should see the stored data and the free space the ring really has
+
+    uint8_t data[128], result[128];
+    std::string name = "/libcb-test-late-" + std::to_string(getpid());
+    CircularBufferShm first, late;
+
+    ASSERT_EQ(circularBufferShmCreate(&first, name.c_str(), 128, LIBCB_SHM_FLAG_SPSC), LIBCB_SUCCESS);
+
+    fillChunk(data, sizeof(data), 0);
+
+    EXPECT_EQ(circularBufferShmPush(&first, data, 100), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferShmPop(&first, result, 100), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferShmPush(&first, data, 60), LIBCB_SUCCESS);
+
+    ASSERT_EQ(circularBufferShmAttach(&late, name.c_str()), LIBCB_SUCCESS);
+
+    EXPECT_EQ(circularBufferShmPush(&late, data + 60, 100), LIBCB_BUFFEROVERFLOW);
+    EXPECT_EQ(circularBufferShmPush(&late, data + 60, 68), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferShmGetCount(&late), 128);
+    EXPECT_EQ(circularBufferShmPop(&late, result, sizeof(result)), LIBCB_SUCCESS);
+    EXPECT_EQ(memcmp(result, data, sizeof(data)), 0);
+    EXPECT_EQ(circularBufferShmPop(&late, result, 1), LIBCB_BUFFEREMPTY);
+
+    EXPECT_EQ(circularBufferShmDetach(&late), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferShmDetach(&first), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferShmUnlink(name.c_str()), LIBCB_SUCCESS);
+}
+
+TEST(CircularBufferShm, TestHeaderRewritten)
+{
+    // let a peer rewrite the geometry and the mode in the header after the attach
+    // the views should keep working with what was validated when they were set up
+
+    uint8_t data[128], result[128];
+    std::string name = "/libcb-test-rewritten-" + std::to_string(getpid());
+    CircularBufferShm producer, consumer;
+
+    ASSERT_EQ(circularBufferShmCreate(&producer, name.c_str(), 128, LIBCB_SHM_FLAG_NONE), LIBCB_SUCCESS);
+    ASSERT_EQ(circularBufferShmAttach(&consumer, name.c_str()), LIBCB_SUCCESS);
+
+    producer.pHeader->nBufferSize = 1u << 30;
+    producer.pHeader->nFlags = LIBCB_SHM_FLAG_SPSC;
+
+    fillChunk(data, sizeof(data), 0);
+
+    EXPECT_EQ(circularBufferShmPush(&producer, data, sizeof(data)), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferShmPush(&producer, data, 1), LIBCB_BUFFEROVERFLOW);
+    EXPECT_EQ(circularBufferShmPop(&consumer, result, 4096), LIBCB_BUFFERUNDERFLOW);
+    EXPECT_EQ(circularBufferShmPop(&consumer, result, sizeof(result)), LIBCB_SUCCESS);
+    EXPECT_EQ(memcmp(result, data, sizeof(data)), 0);
+
+    // a view attached after the rewrite should refuse the header
+    CircularBufferShm late;
+
+    EXPECT_EQ(circularBufferShmAttach(&late, name.c_str()), LIBCB_INVALIDPARAM);
+
+    EXPECT_EQ(circularBufferShmDetach(&consumer), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferShmDetach(&producer), LIBCB_SUCCESS);
+    EXPECT_EQ(circularBufferShmUnlink(name.c_str()), LIBCB_SUCCESS);
+}
+
+// a child process attaches by name and streams totalBytes to the parent
+static void runTwoProcesses(uint32_t flags)
+{
+    const uint64_t totalBytes = 64ull << 20;
+    std::string name = "/libcb-test-" + std::to_string(getpid()) + "-" + std::to_string(flags);
+    CircularBufferShm shm;
+
+    ASSERT_EQ(circularBufferShmCreate(&shm, name.c_str(), 64 * 1024, flags), LIBCB_SUCCESS);
+
+    pid_t child = fork();
+
+    ASSERT_GE(child, 0);
+
+    if (child == 0)
+    {
+        CircularBufferShm producer;
+        uint8_t chunk[1500];
+        uint64_t sent = 0;
+
+        if (circularBufferShmAttach(&producer, name.c_str()) != LIBCB_SUCCESS)
+        {
+            _exit(1);
+        }
+
+        while (sent < totalBytes)
+        {
+            uint32_t size = (uint32_t)std::min<uint64_t>(64 + sent % 1400, totalBytes - sent);
+
+            fillChunk(chunk, size, sent);
+
+            while (circularBufferShmPush(&producer, chunk, size) != LIBCB_SUCCESS)
+            {
+                std::this_thread::yield();
+            }
+
+            sent += size;
+        }
+
+        _exit(0);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    uint8_t chunk[1024], expected[1024];
+    uint64_t received = 0, mismatches = 0;
+
+    while (received < totalBytes)
+    {
+        uint32_t size = (uint32_t)std::min<uint64_t>(sizeof(chunk), totalBytes - received);
+
+        if (circularBufferShmPop(&shm, chunk, size) != LIBCB_SUCCESS)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        fillChunk(expected, size, received);
+        mismatches += memcmp(chunk, expected, size) != 0;
+        received += size;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    int childStatus = 0;
+
+    waitpid(child, &childStatus, 0);
+
+    EXPECT_TRUE(WIFEXITED(childStatus) && WEXITSTATUS(childStatus) == 0);
+    EXPECT_EQ(mismatches, 0u);
+
+    ::testing::Test::RecordProperty("MiBPerSecond", std::to_string((int)(totalBytes / seconds / (1 << 20))));
+
+    circularBufferShmDetach(&shm);
+    circularBufferShmUnlink(name.c_str());
+}
+
+TEST(CircularBufferShm, TestTwoProcessesSpsc)
+{
+    // stream data from a child process through the lock-free shared ring
+    // every byte should arrive in order
+
+    runTwoProcesses(LIBCB_SHM_FLAG_SPSC);
+}
+
+TEST(CircularBufferShm, TestTwoProcessesLocked)
+{
+    // the same stream through the process-shared spinlock
+
+    runTwoProcesses(LIBCB_SHM_FLAG_NONE);
+}